@@ -1,9 +1,10 @@
 /**
  * @file loglib.hpp
  * @brief 简单的日志库实现
- * @details 提供基础的日志记录功能，支持不同日志级别和时间戳
+ * @details 提供基础的日志记录功能，支持不同日志级别和时间戳，
+ *          可选异步模式：无锁队列 + 后台批量写入 + 按大小轮转
  * @author AutoTestlib
- * @version 1.0
+ * @version 1.1
  * @date 创建于未知日期
  */
 #ifndef LOGLIB_H
@@ -14,6 +15,15 @@
 #include <fstream>
 #include <ctime>
 #include <filesystem>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <sys/stat.h>
 
  /**
   * @namespace log
@@ -49,6 +59,308 @@ namespace loglib{
         WHITE=37
     };
 
+    /**
+     * @enum Sink
+     * @brief 日志输出目标
+     */
+    enum Sink{
+        SINK_CONSOLE=0, ///< 终端
+        SINK_FILE       ///< 日志文件
+    };
+
+    /**
+     * @brief 获取日志级别的优先级
+     * @details DEBUG 最低，ERROR 最高，用于按目标过滤日志
+     * @param level 日志级别
+     * @return 优先级数值
+     */
+    inline int get_priority(LogLevel level){
+        switch(level){
+        case DEBUG:
+            return 0;
+        case INFO:
+            return 1;
+        case WARNING:
+            return 2;
+        case ERROR:
+            return 3;
+        default:
+            return 1;
+        }
+    }
+
+    /**
+     * @class RingBuffer
+     * @brief 无锁有界环形队列
+     * @details 多生产者多消费者，每个槽位带序号，入队出队只使用原子操作
+     */
+    template<typename T>
+    class RingBuffer{
+        struct Cell{
+            std::atomic<size_t> sequence;
+            T data;
+        };
+        std::unique_ptr<Cell[]> _buffer;  ///< 槽位
+        size_t _mask;                     ///< 容量掩码
+        alignas(64) std::atomic<size_t> _enqueue{ 0 };  ///< 入队位置
+        alignas(64) std::atomic<size_t> _dequeue{ 0 };  ///< 出队位置
+    public:
+        /**
+         * @brief 构造函数
+         * @param capacity 容量，向上取整为2的幂
+         */
+        explicit RingBuffer(size_t capacity){
+            size_t size=2;
+            while(size<capacity){
+                size<<=1;
+            }
+            _buffer.reset(new Cell[size]);
+            _mask=size-1;
+            for(size_t i=0; i<size; i++){
+                _buffer[i].sequence.store(i,std::memory_order_relaxed);
+            }
+        }
+
+        /**
+         * @brief 入队
+         * @param value 数据
+         * @return 队列已满时返回false
+         */
+        bool push(T &&value){
+            Cell *cell;
+            size_t pos=_enqueue.load(std::memory_order_relaxed);
+            while(true){
+                cell=&_buffer[pos&_mask];
+                size_t seq=cell->sequence.load(std::memory_order_acquire);
+                intptr_t dif=(intptr_t)seq-(intptr_t)pos;
+                if(dif==0){
+                    if(_enqueue.compare_exchange_weak(pos,pos+1,std::memory_order_relaxed)){
+                        break;
+                    }
+                }
+                else if(dif<0){
+                    return false;
+                }
+                else{
+                    pos=_enqueue.load(std::memory_order_relaxed);
+                }
+            }
+            cell->data=std::move(value);
+            cell->sequence.store(pos+1,std::memory_order_release);
+            return true;
+        }
+
+        /**
+         * @brief 出队
+         * @param value 接收数据
+         * @return 队列为空时返回false
+         */
+        bool pop(T &value){
+            Cell *cell;
+            size_t pos=_dequeue.load(std::memory_order_relaxed);
+            while(true){
+                cell=&_buffer[pos&_mask];
+                size_t seq=cell->sequence.load(std::memory_order_acquire);
+                intptr_t dif=(intptr_t)seq-(intptr_t)(pos+1);
+                if(dif==0){
+                    if(_dequeue.compare_exchange_weak(pos,pos+1,std::memory_order_relaxed)){
+                        break;
+                    }
+                }
+                else if(dif<0){
+                    return false;
+                }
+                else{
+                    pos=_dequeue.load(std::memory_order_relaxed);
+                }
+            }
+            value=std::move(cell->data);
+            cell->sequence.store(pos+_mask+1,std::memory_order_release);
+            return true;
+        }
+    };
+
+    /**
+     * @class AsyncWriter
+     * @brief 异步日志写入器
+     * @details 后台线程持有一个打开的文件描述符，批量写入环形队列中的日志，
+     *          并在文件超过指定大小时轮转
+     */
+    class AsyncWriter{
+        RingBuffer<std::string> _ring;         ///< 日志队列
+        fs::path _file;                        ///< 日志文件
+        int _fd=-1;                            ///< 文件描述符
+        size_t _size=0;                        ///< 当前文件大小
+        std::atomic<size_t> _maxSize{ 0 };     ///< 轮转大小，0 表示不轮转
+        std::atomic<int> _backups{ 3 };        ///< 保留的轮转文件数量
+        std::atomic<size_t> _pushed{ 0 };      ///< 已入队条数
+        std::atomic<size_t> _written{ 0 };     ///< 已写入条数
+        std::atomic<bool> _stop{ false };      ///< 停止标志
+        bool _wake=false;                      ///< 唤醒标志
+        std::mutex _mutex;
+        std::condition_variable _cv;           ///< 唤醒写线程
+        std::condition_variable _doneCv;       ///< 通知写入完成
+        std::thread _thread;                   ///< 写线程
+
+        /**
+         * @brief 打开日志文件
+         */
+        void open(){
+            _fd=::open(_file.c_str(),O_WRONLY|O_CREAT|O_APPEND|O_CLOEXEC,0644);
+            struct stat st;
+            _size=(_fd!=-1&&::fstat(_fd,&st)==0)?st.st_size:0;
+        }
+
+        /**
+         * @brief 写入全部数据
+         * @param data 数据
+         */
+        void write_all(const std::string &data){
+            if(_fd==-1){
+                return;
+            }
+            const char *ptr=data.data();
+            size_t left=data.size();
+            while(left>0){
+                ssize_t n=::write(_fd,ptr,left);
+                if(n<0){
+                    if(errno==EINTR) continue;
+                    return;
+                }
+                ptr+=n;
+                left-=n;
+            }
+            _size+=data.size();
+        }
+
+        /**
+         * @brief 按大小轮转日志文件: name -> name.1 -> name.2 ...
+         */
+        void rotate(){
+            size_t maxSize=_maxSize.load();
+            if(maxSize==0||_size<maxSize){
+                return;
+            }
+            ::close(_fd);
+            int backups=_backups.load();
+            std::error_code ec;
+            for(int i=backups-1; i>=1; i--){
+                fs::path from=_file.string()+"."+std::to_string(i);
+                fs::path to=_file.string()+"."+std::to_string(i+1);
+                if(fs::exists(from,ec)){
+                    fs::rename(from,to,ec);
+                }
+            }
+            if(backups>0){
+                fs::rename(_file,_file.string()+".1",ec);
+            }
+            else{
+                fs::remove(_file,ec);
+            }
+            open();
+        }
+
+        /**
+         * @brief 写线程主循环
+         */
+        void loop(){
+            std::string line;
+            std::string batch;
+            while(true){
+                batch.clear();
+                size_t count=0;
+                while(count<1024&&_ring.pop(line)){
+                    batch+=line;
+                    count++;
+                }
+                if(count>0){
+                    write_all(batch);
+                    rotate();
+                    _written.fetch_add(count);
+                    std::lock_guard<std::mutex> lock(_mutex);
+                    _doneCv.notify_all();
+                    continue;
+                }
+                if(_stop.load()){
+                    break;
+                }
+                std::unique_lock<std::mutex> lock(_mutex);
+                _cv.wait_for(lock,std::chrono::milliseconds(20),[this]{ return _wake||_stop.load(); });
+                _wake=false;
+            }
+        }
+
+        /**
+         * @brief 唤醒写线程
+         */
+        void wake(){
+            std::lock_guard<std::mutex> lock(_mutex);
+            _wake=true;
+            _cv.notify_one();
+        }
+    public:
+        /**
+         * @brief 构造函数
+         * @param file 日志文件
+         * @param capacity 队列容量
+         */
+        AsyncWriter(const fs::path &file,size_t capacity=4096)
+            :_ring(capacity),_file(file){
+            open();
+            _thread=std::thread([this]{ loop(); });
+        }
+
+        /**
+         * @brief 设置轮转参数
+         * @param maxSize 单个文件的最大字节数，0 表示不轮转
+         * @param backups 保留的轮转文件数量
+         */
+        void set_rotate(size_t maxSize,int backups){
+            _maxSize=maxSize;
+            _backups=backups;
+        }
+
+        /**
+         * @brief 写入一行日志，队列满时等待写线程腾出空间
+         * @param line 日志内容，需要包含换行
+         */
+        void push(std::string line){
+            while(!_ring.push(std::move(line))){
+                wake();
+                std::this_thread::yield();
+            }
+            _pushed.fetch_add(1);
+        }
+
+        /**
+         * @brief 同步等待已入队的日志全部写入文件
+         */
+        void flush(){
+            size_t target=_pushed.load();
+            std::unique_lock<std::mutex> lock(_mutex);
+            _wake=true;
+            _cv.notify_one();
+            _doneCv.wait(lock,[this,target]{ return _written.load()>=target; });
+        }
+
+        /**
+         * @brief 析构函数，写完剩余日志后关闭文件
+         */
+        ~AsyncWriter(){
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                _stop=true;
+                _cv.notify_one();
+            }
+            if(_thread.joinable()){
+                _thread.join();
+            }
+            if(_fd!=-1){
+                ::close(_fd);
+            }
+        }
+    };
+
     /**
      * @class Log
      * @brief 日志记录类
@@ -57,8 +369,35 @@ namespace loglib{
     class Log{
         // 私有成员
         std::string _log_content;  ///< 日志内容
+        LogLevel _last_level=INFO;  ///< 上一条不换行日志的级别
         fs::path _PATH=fs::current_path();  ///< 日志路径
         std::string _name="server.log";    ///< 日志文件名
+        std::shared_ptr<AsyncWriter> _writer;  ///< 异步写入器，为空时同步写入
+        size_t _capacity=4096;             ///< 异步队列容量
+        size_t _rotateSize=0;              ///< 轮转大小
+        int _rotateBackups=3;              ///< 轮转文件数量
+        LogLevel _levels[2]={ DEBUG,DEBUG };  ///< 各输出目标的最低级别
+        std::time_t _lastSec=0;            ///< 上次格式化时间戳的秒数
+        std::string _lastTime;             ///< 缓存的时间戳
+
+        /**
+         * @brief 重新创建异步写入器，路径或文件名变化时调用
+         */
+        void reopen(){
+            if(_writer){
+                _writer=std::make_shared<AsyncWriter>(_PATH/_name,_capacity);
+                _writer->set_rotate(_rotateSize,_rotateBackups);
+            }
+        }
+
+        /**
+         * @brief 是否输出到指定目标
+         * @param sink 输出目标
+         * @param level 日志级别
+         */
+        bool allow(Sink sink,LogLevel level){
+            return get_priority(level)>=get_priority(_levels[sink]);
+        }
 
         /**
          * @brief 获取日志级别的字符串表示
@@ -126,12 +465,17 @@ namespace loglib{
          */
         std::string get_time(){
             std::time_t now_sec=std::time(nullptr);
+            // 同一秒内复用上次的结果
+            if(now_sec==_lastSec&&!_lastTime.empty()){
+                return _lastTime;
+            }
+            _lastSec=now_sec;
             auto now=*std::localtime(&now_sec);
             char timestamp[20];
             std::strftime(timestamp,sizeof(timestamp),"%Y/%m/%d-%H:%M:%S",&now);
             std::string now_time=timestamp;
-            std::string stringTime="["+now_time+"]";
-            return stringTime;
+            _lastTime="["+now_time+"]";
+            return _lastTime;
         }
     public:
         /**
@@ -154,6 +498,7 @@ namespace loglib{
          */
         void set_logName(std::string name){
             _name=name;
+            reopen();
         }
 
         /**
@@ -166,6 +511,54 @@ namespace loglib{
             if(!fs::exists(_PATH)){
                 fs::create_directories(_PATH);
             }
+            reopen();
+        }
+
+        /**
+         * @brief 开启或关闭异步模式
+         * @details 异步模式下由后台线程批量写入文件，ERROR 级别和析构时同步刷新
+         * @param enable 是否开启
+         * @param capacity 队列容量
+         */
+        void set_async(bool enable,size_t capacity=4096){
+            _capacity=capacity;
+            if(!enable){
+                _writer.reset();
+                return;
+            }
+            _writer=std::make_shared<AsyncWriter>(_PATH/_name,_capacity);
+            _writer->set_rotate(_rotateSize,_rotateBackups);
+        }
+
+        /**
+         * @brief 设置日志文件轮转，仅异步模式生效
+         * @param maxSize 单个文件的最大字节数，0 表示不轮转
+         * @param backups 保留的轮转文件数量
+         */
+        void set_rotate(size_t maxSize,int backups=3){
+            _rotateSize=maxSize;
+            _rotateBackups=backups;
+            if(_writer){
+                _writer->set_rotate(maxSize,backups);
+            }
+        }
+
+        /**
+         * @brief 设置输出目标的最低日志级别
+         * @param sink 输出目标
+         * @param level 最低级别，低于该级别的日志不会输出
+         */
+        void set_level(Sink sink,LogLevel level){
+            _levels[sink]=level;
+        }
+
+        /**
+         * @brief 同步刷新异步队列中的日志
+         */
+        void flush(){
+            if(_writer){
+                _writer->flush();
+            }
         }
 
         /**
@@ -173,7 +566,17 @@ namespace loglib{
          * @param content 要写入的内容
          * @param level 日志等级
          */
-        void wlog(std::string content){
+        void wlog(std::string content,LogLevel level=INFO){
+            if(!allow(SINK_FILE,level)){
+                return;
+            }
+            if(_writer){
+                _writer->push(content+"\n");
+                if(level==ERROR){
+                    _writer->flush();
+                }
+                return;
+            }
             std::ofstream log_file(_PATH/_name,std::ios::app);
             if(log_file.is_open()){
                 log_file<<content<<std::endl;
@@ -190,9 +593,11 @@ namespace loglib{
          */
         void log(std::string str,LogLevel level=INFO){
             _log_content=get_string(level)+' '+str;
-            auto &logs=(level==ERROR)?std::cerr:std::cout;
-            logs<<set_color(_log_content,level)<<std::endl;
-            wlog(_log_content);
+            if(allow(SINK_CONSOLE,level)){
+                auto &logs=(level==ERROR)?std::cerr:std::cout;
+                logs<<set_color(_log_content,level)<<std::endl;
+            }
+            wlog(_log_content,level);
         }
 
         /**
@@ -202,9 +607,11 @@ namespace loglib{
          */
         void tlog(std::string str,LogLevel level=INFO){
             _log_content=get_time()+" "+get_string(level)+" "+str;
-            auto &logs=(level==ERROR)?std::cerr:std::cout;
-            logs<<set_color(_log_content,level)<<std::endl;
-            wlog(_log_content);
+            if(allow(SINK_CONSOLE,level)){
+                auto &logs=(level==ERROR)?std::cerr:std::cout;
+                logs<<set_color(_log_content,level)<<std::endl;
+            }
+            wlog(_log_content,level);
         }
         /**
          * @brief 更新当前这一行的日志，不换行记录
@@ -213,6 +620,10 @@ namespace loglib{
          */
         void llog(std::string str,LogLevel level=INFO){
             _log_content=get_string(level)+" "+str;
+            _last_level=level;
+            if(!allow(SINK_CONSOLE,level)){
+                return;
+            }
             auto &logs=(level==ERROR)?std::cerr:std::cout;
             // 输出控制 回到行
             logs<<"\r"<<set_color(_log_content,level)<<std::flush;
@@ -224,6 +635,10 @@ namespace loglib{
          */
         void tllog(std::string str,LogLevel level=INFO){
             _log_content=get_time()+" "+get_string(level)+" "+str;
+            _last_level=level;
+            if(!allow(SINK_CONSOLE,level)){
+                return;
+            }
             auto &logs=(level==ERROR)?std::cerr:std::cout;
             logs<<"\r"<<set_color(_log_content,level)<<std::flush;
         }
@@ -231,7 +646,7 @@ namespace loglib{
          * @brief 将上一条日志记录到文件
          */
         void fllog(){
-            wlog(_log_content);
+            wlog(_log_content,_last_level);
         }
         /**
          * @brief 向文件中写入日志
@@ -240,7 +655,7 @@ namespace loglib{
          */
         void flog(std::string str,LogLevel level=INFO){
             _log_content=get_string(level)+' '+str;
-            wlog(_log_content);
+            wlog(_log_content,level);
         }
         /**
          * @brief 向文件中写入带时间戳的日志
@@ -249,7 +664,7 @@ namespace loglib{
          */
         void tflog(std::string str,LogLevel level=INFO){
             _log_content=get_time()+" "+get_string(level)+" "+str;
-            wlog(_log_content);
+            wlog(_log_content,level);
         }
     };
 }
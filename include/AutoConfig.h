@@ -50,6 +50,43 @@ namespace acm{
         Edge, // > 边界
         Test_Weight, // > 测试权重
         Weights, // > 权重
+        Storage, // > 数据存储方式
+        Retention, // > 数据保留策略
+        KeepSlowest, // > 保留最慢测试点的数量
+        MasterSeed, // > 主种子
+        ShardCount, // > 分片数量
+        ShardIndex, // > 当前分片编号
+        CacheLimit, // > 编译缓存大小上限(MB)
+        CompileJobs, // > 同时编译的数量
+        Minimize, // > 是否最小化错误样例
+        MinimizeBudget, // > 最小化的判定次数上限
+        HuntRounds, // > 性能搜索的轮数
+        HuntPopulation, // > 性能搜索每轮的候选数量
+        PerfKeep, // > 性能语料保留的数量
+        ComplexityPoints, // > 复杂度估计的规模数量
+        ComplexityRepeat, // > 复杂度估计每个规模的重复次数
+        CoverageExecs, // > 覆盖率引导模式的运行次数
+        MutateCount, // > 变异模式生成的变异数量
+        Scheduler, // > 生成参数的自适应调度策略
+        TimeScale, // > 时间限制的倍率
+        ApplyTimeScale, // > 是否把时间倍率用于时间限制
+        AutoCalibrate, // > 主机改变时是否自动校准
+        CalibrateRepeat, // > 校准时的数据组数和每组的重复次数
+        CalibrateReference, // > 参考机器上固定负载的用时(us)
+        RetimeCount, // > 接近时间限制的运行重复计时的次数
+        RetimeMargin, // > 触发重复计时的范围,时间限制的比例
+        RetimeNoise, // > 判定计时不稳定的波动
+        ContinueOnFailure, // > 测试代码超时或运行错误时是否继续对拍
+        PerfCounters, // > 是否记录性能计数器
+        InstructionBudget, // > 指令数预算
+        CorePlacement, // > 是否按计时CPU和辅助CPU分配
+        CoreMap, // > 计时CPU和辅助CPU
+        Diagnose, // > 是否诊断失败的样例
+        References, // > 额外的参考解
+        ToolTimeLimit, // > 生成器和验证器的时间预算
+        ToolMemLimit, // > 生成器和验证器的内存预算
+        MaxRejections, // > 同一测试点连续被拒绝的次数上限
+        RegenerateTools, // > 超出预算时是否重新生成工具
     };
     // 配置类
     class AutoConfig{
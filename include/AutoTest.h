@@ -5,6 +5,10 @@
 #include <memory>
 #include <filesystem>
 #include <unordered_map>
+#include <map>
+#include <set>
+#include <future>
+#include <thread>
 #include "openai.hpp"
 #include "json.hpp"
 #include "loglib.hpp"
@@ -12,6 +16,12 @@
 #include "KeyCircle.h"
 #include "AutoConfig.h"
 #include "AutoJson.h"
+#include "Journal.h"
+#include "Corpus.h"
+#include "Bandit.h"
+#include "Placement.h"
+#include "Judge.h"
+#include "Compiler.h"
 
 namespace acm{
     using json=nlohmann::json;
@@ -39,6 +49,48 @@ namespace acm{
         ns::TestConfig _temp_config;
         // 测试配置初始化
         void init_test_config();
+        // 进度日志,记录频繁变化的计数
+        Journal _journal;
+        // 初始化进度日志并回放到配置
+        void init_journal();
+        // 记录进度
+        void progress(const json &entry);
+        // 写入检查点并压缩进度日志,同时写入内存中的运行统计
+        void checkpoint();
+        // 写入内存中的运行统计
+        void save_stats();
+        // 编译器,编译结果缓存在 config/cache 中
+        Compiler _compiler;
+        // 编译源文件到可执行文件,可以在后台线程中调用
+        CompileResult compile(const fs::path &src,const fs::path &target,const std::vector<string> &flags);
+        // 目标对应的编译配置角色
+        string role(ConfigSign name);
+        // 目标的编译参数,来自 compile_profiles
+        std::vector<string> profile(ConfigSign name);
+        // 目标的版本键,由源文件和编译参数决定,保存在 exec/<目标>.key
+        uint64_t binary_key(ConfigSign name,const fs::path &src);
+        // 目标的源文件键,只由源文件和本地头文件决定,用于判断数据是否失效
+        uint64_t source_key(ConfigSign name,const fs::path &src);
+        // 可执行文件是否存在且与源文件和编译参数一致
+        bool up_to_date(ConfigSign name,const fs::path &src);
+        // 目标对应的源文件
+        fs::path source(ConfigSign name);
+        // 依赖记录,保存产生现有数据的各个程序的版本键
+        AutoConfig _depend;
+        // 检查依赖,程序改变时只清除受影响的数据
+        void check_depend();
+        // 清除数据: 输入、标准输出、测试输出和判题结果
+        void invalidate(bool inputs,bool acOutputs,bool verdicts);
+        // 复用仍然有效的标准输出
+        bool reuse_ac(int num);
+        // 后台编译任务,按目标名称索引
+        std::map<string,std::shared_future<CompileResult>> _jobs;
+        // 提交后台编译任务
+        void submit(ConfigSign name,const fs::path &src);
+        // 是否有未取回的编译任务
+        bool pending(ConfigSign name) const;
+        // 取回编译结果并输出诊断信息,没有后台任务时直接编译
+        CompileResult ensure(ConfigSign name,const fs::path &src);
         // 测试程序名称
         string _name;
         // 测试数据路径
@@ -99,8 +151,13 @@ namespace acm{
         bool full_check();
         // 错误样例集合
         AutoConfig _WAdatas;
-        // 添加当前样例到错误集合
-        void add_WAdatas();
+        // 添加当前样例到错误集合,开启 minimize 时同时保存最小化的样例
+        void add_WAdatas(int num,JudgeCode verdict);
+        void add_WAdatas(const string &in,const string &out,JudgeCode verdict);
+        // 最小化输入,保持验证器通过且测试代码得到相同的判题结果,out 为最小样例的标准输出,失败时为空
+        string minimize(const string &in,JudgeCode verdict,string &out);
+        // 诊断失败的样例,用消毒器版本重新运行,超内存时分析内存,返回诊断报告
+        string diagnose(const string &in,JudgeCode verdict);
         // cph路径
         fs::path _cph=".";
         // 设置cph文件夹路径
@@ -108,17 +165,123 @@ namespace acm{
         // 查找对应cph文件路径
         string search_test_cph();
         // 修改源文件目录下.cph配置，将错误样例自动加入
-        void add_to_cph();
+        void add_to_cph(const json &test);
         // 数据存储文件夹
         std::vector<fs::path> _dataDirs;
         // 数据文件夹访问
         enum DataFloder{ inData,outData,acData };
+        // 打包语料库
+        Corpus _corpus;
+        // 是否使用打包存储
+        bool _packed=false;
+        // 打包存储时的工作区
+        fs::path _workPath;
+        // 工作区中数据对应的测试点编号
+        int _workData=0;
+        // 只保存种子,通过的测试点按需重新生成
+        bool _seedOnly=false;
+        // 生成器哈希缓存
+        uint64_t _genHash=0;
+        fs::file_time_type _genTime;
+        // 生成器可执行文件哈希
+        uint64_t generator_hash();
+        // 按种子重新生成测试点输入
+        bool materialize(int num,const fs::path &file);
+        // 测试点数据路径
+        fs::path data_path(DataFloder floder,int num);
+        // 测试点是否存在
+        bool has_data(int num);
+        // 读取测试点数据
+        string read_data(DataFloder floder,int num);
+        // 准备测试点输入到工作区
+        bool load_data(int num);
+        // 保存工作区中的测试点数据
+        void store_data(DataFloder floder,int num,bool force=false);
+        // 记录判题结果并按保留策略决定是否保存数据
+        void retain(int num,JudgeCode verdict,int time);
         // 初始化其余配置
         bool init_temp();
+        // 主种子,测试点的随机哈希和模式只取决于主种子和编号
+        uint64_t _master=0;
+        // 分片,只生成 (num-1)%_shardCount==_shardIndex 的测试点
+        int _shardCount=1;
+        int _shardIndex=0;
+        // 重复计时的次数、触发范围和判定不稳定的波动
+        int _retimeCount=5;
+        double _retimeMargin=0.2;
+        double _retimeNoise=0.2;
+        // 是否已提示指令数预算退回到墙钟时间
+        bool _budgetWarned=false;
+        // 当前测试点的重试次数
+        int _attemptData=0;
+        int _attempt=0;
         // 生成随机字符串
-        string random_string(int length);
+        string random_string(int length,uint64_t key);
         // 生成指定权重数字
-        int random_weight(int val0,int val1,int val2);
+        int random_weight(int val0,int val1,int val2,uint64_t key);
+        // 测试点的生成器模式
+        int select_mode(int num);
+        // 自适应调度器,未启用时为空
+        std::unique_ptr<Bandit> _bandit;
+        // 调度器统计,只在检查点写入
+        AutoConfig _banditState;
+        bool _banditDirty=false;
+        // 已生成但还没有判题的测试点选择的臂和生成耗时
+        struct Pull{
+            size_t arm;
+            double cost;
+        };
+        std::map<int,Pull> _pulls;
+        // 本次运行生成过的输入哈希,用于统计重复
+        std::set<uint64_t> _inputHashes;
+        // 初始化自适应调度器
+        bool init_scheduler();
+        // 记录调度生成的测试点的判题结果
+        void schedule(int num,JudgeCode verdict,int time);
+        // 主机改变时重新校准时间限制
+        void check_calibration();
+        // CPU分配,未启用时计时运行不绑定CPU
+        Placement _placement;
+        bool _placed=false;
+        // 初始化CPU分配
+        bool init_placement();
+        // 额外的参考解,与AC代码在同一输入上交叉验证
+        struct Reference{
+            // 名称
+            string name;
+            // 源文件
+            fs::path file;
+            // 只在输入不超过该字节数时运行, 0 为不限制
+            size_t maxInputBytes=0;
+            // 时间限制(ms), 0 时使用题目的时间限制
+            int timeLimit=0;
+        };
+        std::vector<Reference> _references;
+        // 判题矩阵和不一致的输入,只在检查点写入
+        AutoConfig _referenceState;
+        bool _referenceDirty=false;
+        // 读取参考解配置
+        bool init_references();
+        // 编译参考解
+        bool compile_references();
+        // 在测试点上并行运行参考解,用检查器与AC代码的标准输出比较,返回每个参考解的判题结果,不运行的参考解没有结果
+        json cross_check(int num);
+        // 记录判题矩阵的一行,参考解与AC代码不一致时保存输入
+        void report_references(int num,const json &verdicts,JudgeCode verdict);
+        // 生成器和验证器的时间(ms)和内存(MB)预算
+        int _toolTime=10000;
+        int _toolMemory=1024;
+        // 生成器和验证器的运行统计,只在检查点写入
+        AutoConfig _toolStats;
+        bool _toolStatsDirty=false;
+        // 同一测试点连续被验证器拒绝的次数
+        int _rejections=0;
+        // 本次运行中已经重新生成过的工具
+        std::set<ConfigSign> _regenerated;
+        // 是否为需要独占计时CPU的程序
+        bool timed(const fs::path &program);
+        // 测试点是否属于当前分片
+        bool in_shard(int num);
         // 随机数种子保存
         string _randomSeed;
         // 保存到文件
@@ -152,8 +315,8 @@ namespace acm{
         bool load(const fs::path &path);
         // 初始化结构
         bool init();
-        // 测试工具生成编译
-        bool make(ConfigSign name,json &session);
+        // 测试工具生成编译, hint 非空时附加到提示词后面
+        bool make(ConfigSign name,json &session,const string &hint="");
         // 生成测试工具
         AutoTest &ai_gen();
         // 退出状态
@@ -162,15 +325,110 @@ namespace acm{
             int exit_code;
             string content;
             string error;
+            // 完整的错误输出,保留换行,用于解析消毒器报告
+            string report;
+            // CPU时间(ms)
+            int time=0;
+            // CPU时间(us),用于需要更高精度的计时
+            long long timeUs=0;
+            // 墙钟时间(ms)
+            int wall=0;
+            // 峰值内存(KB)
+            long memory=0;
+            // 性能计数器
+            process::CounterValues counters;
+            // 绑定的计时CPU, -1 为未绑定
+            int cpu=-1;
+            // 重复计时的记录,为空时没有重复计时,由主线程写入日志
+            json retimed;
+            // 指令计数不可用,指令数预算退回到按墙钟时间判定,由主线程写入日志
+            bool wallBudget=false;
+        };
+        // 运行限制,0 为不限制
+        struct Limit{
+            // 时间限制(ms)
+            int time=0;
+            // 内存限制(MB)
+            int memory=0;
+            // 绑定的CPU,为空时不绑定
+            std::vector<int> cpus;
+            // 是否记录性能计数器
+            bool counters=false;
+            // 指令数预算, 0 为不限制
+            long long instructions=0;
         };
+        // 当前配置的运行限制
+        Limit limit();
+        // 生成器和验证器每次运行的时间和内存预算
+        Limit tool_limit();
+        // 记录一次工具运行, bytes 为生成的数据大小
+        void record_tool(ConfigSign name,const Exit &res,size_t bytes,bool rejected);
+        // 工具超出预算时按配置用统计重新生成,重新生成成功时返回true
+        bool regenerate_tool(ConfigSign name,const string &reason);
         // 进行测试
         Exit run(fs::path program,process::Args args,fs::path infile="",fs::path outfile="",bool setLimit=true);
+        // 使用指定限制进行测试,不读取配置,可以在多个线程中同时调用
+        Exit run(fs::path program,process::Args args,fs::path infile,fs::path outfile,const Limit &limit,const std::map<string,string> &env={});
+        // 正常结束但用时接近时间限制或超时的运行在绑定的CPU上重复计时,按中位数判定是否超时,可以在多个线程中同时调用
+        Exit retime(const fs::path &program,const process::Args &args,const fs::path &in,const fs::path &out,const Limit &limit,const Exit &first,const string &name);
+        // 把重复计时的记录写入日志和 stats.jsonl,只在主线程中调用
+        void report_retime(const json &line);
+        // 指令数预算退回到墙钟时间时提示一次,只在主线程中调用
+        void report_budget(bool wallBudget);
+        // 对一组输入和标准输出运行测试代码和检查器,repeat 为 false 时不重复计时,可以在多个线程中同时调用
+        JudgeCode judge_case(const fs::path &in,const fs::path &out,const fs::path &ans,const Limit &limit,Exit &res,bool repeat=true);
+        // 对已有的测试输出运行检查器,检查器自身出错时返回 Waiting,可以在多个线程中同时调用
+        JudgeCode check_case(const fs::path &in,const fs::path &out,const fs::path &ans,Exit &res);
+        // 性能搜索的一组生成参数和结果
+        struct PerfCase{
+            // 生成器参数: 模式1 <种子> <规模千分比> <形态>
+            string seed;
+            int scale=1000;
+            int shape=0;
+            // 输入文件,为空时由生成器生成
+            fs::path in;
+            JudgeCode verdict=Waiting;
+            // 测试代码和AC代码的CPU时间(ms)
+            int testTime=0;
+            int acTime=0;
+            string error;
+            // 重复计时的记录
+            json retimed;
+            // 指令数预算是否退回到墙钟时间
+            bool wallBudget=false;
+            // 测试代码与AC代码的用时比
+            double ratio() const;
+            // 参数的唯一名称
+            string name() const;
+        };
+        // 运行一组性能测试参数,可以在多个线程中同时调用
+        bool perf_case(PerfCase &c,const fs::path &dir,const Limit &lim);
+        // 并行重放错误样例集合,返回仍然错误的数量
+        int replay_failures();
+        // 重放全部已保存的测试点和错误样例,与上一次重放比较判题结果和用时
+        bool replay(bool stopFirst=false);
+        // 搜索使测试代码相对AC代码最慢的输入,保存为性能语料
+        bool hunt(int rounds=0);
+        // 用固定负载测量机器速度,在最大规模的边界数据上运行AC代码,得到时间倍率和建议的时间、内存限制
+        bool calibrate();
+        // 在按2的幂递增的规模上计时,拟合用时与输入大小的对数斜率并外推到最大规模
+        bool complexity();
+        // 覆盖率引导: 用插桩的测试代码运行生成的输入,优先变异发现新边的种子、模式和参数
+        bool coverage(int execs=0);
+        // 变异错误样例和已保存的输入,经验证器过滤后追加为新测试点并对拍
+        bool mutate(int count=0);
+        // 最小化错误样例集合中还没有最小化的样例
+        bool minimize_failures();
+        // 监视测试代码,保存后重新编译、重放错误样例并继续对拍
+        bool watch();
         // 生成数据
         bool generate_data(int testnum=1);
         // 测试数据
         bool test_data();
         // 开始自动对拍
         bool start();
+        // 导出打包数据为松散文件
+        bool export_data(const fs::path &path);
         // 析构函数
         ~AutoTest();
     };
@@ -0,0 +1,56 @@
+#ifndef BANDIT_H
+#define BANDIT_H
+
+#include <vector>
+#include "json.hpp"
+#include "Self.h"
+
+namespace acm{
+    using json=nlohmann::json;
+    // 多臂老虎机调度
+    // 每个臂是一组生成参数,奖励为发现错误,按单位耗时的错误率选择臂,
+    // 重复和被验证器拒绝的数据也计入次数和耗时,因此会降低对应臂的得分
+    class Bandit{
+    public:
+        // 选择策略
+        enum Policy{ Thompson,UCB };
+        // 一次运行的结果
+        enum Outcome{ Outcome_Pass,Outcome_Failure,Outcome_Duplicate,Outcome_Rejected };
+        // 臂的统计
+        struct Arm{
+            string name;
+            double pulls=0;
+            double failures=0;
+            double duplicates=0;
+            double rejected=0;
+            // 累计耗时(ms)
+            double cost=0;
+            // 平均耗时,没有记录时为1
+            double mean_cost() const;
+        };
+    private:
+        Policy _policy;
+        std::vector<Arm> _arms;
+    public:
+        // 构造函数
+        explicit Bandit(Policy policy=Thompson);
+        // 按名称解析策略,未知名称抛出异常
+        static Policy parse(const string &name);
+        // 添加臂,返回下标
+        size_t add_arm(const string &name);
+        // 臂的数量
+        size_t size() const;
+        // 臂的统计
+        const Arm &arm(size_t index) const;
+        // 选择臂,相同的密钥和统计得到相同的结果
+        size_t select(uint64_t key) const;
+        // 记录一次运行的结果和耗时(ms)
+        void observe(size_t index,Outcome outcome,double cost);
+        // 导出统计
+        json state() const;
+        // 按名称读取统计,忽略不存在的臂
+        void load(const json &state);
+    };
+}
+
+#endif // BANDIT_H
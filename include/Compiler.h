@@ -0,0 +1,83 @@
+#ifndef COMPILER_H
+#define COMPILER_H
+
+#include <vector>
+#include <set>
+#include <mutex>
+#include <condition_variable>
+#include "Self.h"
+#include "Process.h"
+
+namespace acm{
+    // 编译结果
+    struct CompileResult{
+        // 是否编译成功
+        bool ok=false;
+        // 是否命中缓存
+        bool hit=false;
+        // 是否使用了预编译头文件
+        bool pch=false;
+        // 编译错误信息
+        string error;
+        // 缓存键
+        uint64_t key=0;
+    };
+    // 带内容哈希缓存的编译器
+    // 缓存键为 hash(源文件, 引用的本地头文件, 编译器版本, 编译参数),缓存在多个题目文件夹之间共享
+    // 可以在多个线程中同时调用,同时运行的编译器进程数量受 set_jobs 限制
+    class Compiler{
+        // 编译器路径
+        fs::path _compiler="/bin/g++";
+        // 编译器版本缓存
+        string _version;
+        // 缓存文件夹
+        fs::path _cacheDir;
+        // 缓存大小上限
+        uint64_t _limit=1024ull<<20;
+        // 同时运行的编译器数量
+        int _jobs=1;
+        int _running=0;
+        std::mutex _mutex;
+        std::condition_variable _slot;
+        // 同一时间只构建一个预编译头文件,其他线程等待后直接复用
+        std::mutex _pchMutex;
+        // 获取编译槽位
+        void acquire();
+        // 释放编译槽位
+        void release();
+        // 运行编译器
+        process::Status run(const process::Args &args,string &error);
+        // 获取编译器版本
+        const string &version();
+        // 递归哈希本地头文件
+        uint64_t hash_source(const fs::path &file,const std::vector<fs::path> &dirs,std::set<fs::path> &visited,uint64_t hash);
+        // 复制或硬链接到目标
+        bool place(const fs::path &from,const fs::path &to);
+    public:
+        // 构造函数
+        Compiler();
+        Compiler(const Compiler &)=delete;
+        Compiler &operator=(const Compiler &)=delete;
+        // 设置编译器
+        void set_compiler(const fs::path &compiler);
+        // 设置缓存文件夹,为空时不使用缓存
+        void set_cache(const fs::path &dir);
+        // 设置缓存大小上限
+        void set_limit(uint64_t bytes);
+        // 设置同时运行的编译器数量
+        void set_jobs(int jobs);
+        // 计算缓存键
+        uint64_t key(const fs::path &src,const std::vector<string> &flags={});
+        // 只由源文件和引用的本地头文件计算的键,编译参数只用于查找头文件,不随编译器版本和参数改变
+        uint64_t source_key(const fs::path &src,const std::vector<string> &flags={});
+        // 编译源文件到目标,命中缓存时直接链接
+        CompileResult compile(const fs::path &src,const fs::path &target,const std::vector<string> &flags={});
+        // 预编译头文件,每个(头文件内容,编译器,编译参数)只构建一次
+        // 返回使用预编译头文件所需的编译参数,失败时返回空
+        std::vector<string> precompile(const fs::path &header,const std::vector<string> &flags={});
+        // 按最近使用时间淘汰缓存直到不超过上限
+        void evict();
+    };
+}
+
+#endif // COMPILER_H
@@ -0,0 +1,115 @@
+#ifndef CORPUS_H
+#define CORPUS_H
+
+#include <vector>
+#include <string_view>
+#include <cstdint>
+#include "Self.h"
+
+namespace acm{
+    // 语料数据槽位,与数据文件夹顺序一致
+    enum CorpusSlot{ Slot_In=0,Slot_Out,Slot_AC,Slot_Num };
+    // 索引记录,定长,第id个测试点位于 (id-1)*sizeof(CorpusRecord)
+    struct CorpusRecord{
+        // 数据位置
+        struct Slot{
+            uint32_t segment;
+            uint32_t flags;
+            uint64_t offset;
+            uint64_t length;
+        } slot[Slot_Num];
+        // 生成器随机种子
+        char seed[16];
+        // 生成器模式
+        int32_t mode;
+        // 判题结果, -1 为未判题
+        int32_t verdict;
+        // 测试代码运行时间(ms)
+        int32_t time;
+        // 记录标识
+        uint32_t flags;
+        // 生成器哈希
+        uint64_t genHash;
+        // 生成器规模千分比, 0 为不传规模参数
+        int32_t scale;
+        // 保留
+        uint8_t reserved[12];
+    };
+    static_assert(sizeof(CorpusRecord)==128,"CorpusRecord 必须为定长128字节");
+    // 记录标识
+    // 变异数据没有种子,数据必须保留
+    enum CorpusFlag{ Record_Used=1,Record_Mutant=2 };
+
+    // 打包语料库
+    // 数据追加写入段文件,定长索引记录位置,读取时mmap段文件随机访问
+    class Corpus{
+        // 语料库文件夹
+        fs::path _dir;
+        // 索引文件描述符
+        int _indexFd=-1;
+        // 当前追加段
+        int _segFd=-1;
+        uint32_t _segment=0;
+        uint64_t _segSize=0;
+        // 单个段的大小上限
+        uint64_t _segLimit=64ull<<20;
+        // 段映射
+        struct Map{
+            int fd=-1;
+            void *addr=nullptr;
+            size_t size=0;
+        };
+        std::vector<Map> _maps;
+        // 段文件路径
+        fs::path segment_path(uint32_t segment) const;
+        // 打开追加段
+        void open_segment(uint32_t segment);
+        // 追加数据到段,返回位置
+        CorpusRecord::Slot append(const char *data,size_t size);
+        // 映射段文件
+        const char *map(uint32_t segment,uint64_t end);
+        // 写入索引记录
+        void write_record(size_t id,const CorpusRecord &record);
+    public:
+        // 构造函数
+        Corpus();
+        Corpus(const Corpus &)=delete;
+        Corpus &operator=(const Corpus &)=delete;
+        // 打开语料库文件夹,不存在则创建
+        void open(const fs::path &dir);
+        // 文件夹是否为语料库
+        static bool exists(const fs::path &dir);
+        // 是否已经打开
+        bool is_open() const;
+        // 设置单个段的大小上限
+        void set_segment_limit(uint64_t bytes);
+        // 索引中的最大编号
+        size_t size() const;
+        // 读取索引记录,不存在时返回空记录
+        CorpusRecord record(size_t id) const;
+        // 更新索引记录的元数据,不改变数据位置
+        void set_record(size_t id,const CorpusRecord &record);
+        // 是否存在数据
+        bool has(size_t id,CorpusSlot slot) const;
+        // 写入数据
+        void put(size_t id,CorpusSlot slot,std::string_view data);
+        // 从文件写入数据
+        void put_file(size_t id,CorpusSlot slot,const fs::path &file);
+        // 丢弃数据,只清除索引中的位置,段文件中的字节不回收
+        void drop(size_t id,CorpusSlot slot);
+        // 读取数据,返回的视图在下一次写入之前有效
+        std::string_view get(size_t id,CorpusSlot slot);
+        // 读取数据到文件
+        bool get_file(size_t id,CorpusSlot slot,const fs::path &file);
+        // 导出为松散文件 dataN.in/dataN.out
+        size_t export_to(const std::vector<fs::path> &dirs);
+        // 从松散文件导入
+        size_t import_from(const std::vector<fs::path> &dirs);
+        // 关闭
+        void close();
+        // 析构函数
+        ~Corpus();
+    };
+}
+
+#endif // CORPUS_H
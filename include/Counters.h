@@ -0,0 +1,37 @@
+#ifndef COUNTERS_H
+#define COUNTERS_H
+
+#include <sys/types.h>
+
+namespace process{
+    // 性能计数器的值, -1 为不可用
+    struct CounterValues{
+        long long instructions=-1;
+        long long cycles=-1;
+        long long cacheMisses=-1;
+        long long branchMisses=-1;
+        long long pageFaults=-1;
+        // 是否有可用的计数
+        bool any() const;
+    };
+    // perf_event_open 计数器
+    // 为子进程打开后在 exec 时开始计数,线程和子进程继承,只计用户态;
+    // 每个计数器单独打开,虚拟机没有硬件计数器或权限不足时只有部分可用
+    class Counters{
+        enum{ Counter_Num=5 };
+        int _fds[Counter_Num];
+    public:
+        // 构造函数
+        Counters();
+        // 为进程打开计数器,返回是否至少打开了一个
+        bool open(pid_t pid);
+        // 读取计数
+        CounterValues read() const;
+        // 关闭计数器
+        void close();
+        // 析构函数
+        ~Counters();
+    };
+}
+
+#endif // COUNTERS_H
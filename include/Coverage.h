@@ -0,0 +1,59 @@
+#ifndef COVERAGE_H
+#define COVERAGE_H
+
+#include <vector>
+#include <cstdint>
+#include "Self.h"
+
+namespace acm{
+    // 覆盖率位图大小,与运行时桩代码一致
+    const size_t CoverageSize=1<<16;
+    // 运行时桩代码读取的环境变量,值为位图文件路径
+    const char *const CoverageEnv="ACM_COVERAGE";
+    // 共享位图文件,被测程序通过 mmap 写入边的命中次数
+    class CoverageMap{
+        fs::path _file;
+        uint8_t *_data=nullptr;
+    public:
+        // 构造函数
+        CoverageMap()=default;
+        CoverageMap(const CoverageMap &)=delete;
+        CoverageMap &operator=(const CoverageMap &)=delete;
+        // 创建并映射位图文件
+        void open(const fs::path &file);
+        // 清空位图,每次运行前调用
+        void clear();
+        // 位图数据
+        const uint8_t *data() const;
+        // 位图文件路径
+        const fs::path &path() const;
+        // 解除映射
+        void close();
+        // 析构函数
+        ~CoverageMap();
+    };
+    // 累计覆盖率,按 AFL 的方式把命中次数分桶,新的边或新的命中次数桶都算新覆盖
+    class Coverage{
+        // 每个位置已经见过的命中次数桶
+        std::vector<uint8_t> _seen;
+        // 命中次数分桶
+        static uint8_t bucket(uint8_t hits);
+    public:
+        // 构造函数
+        Coverage();
+        // 一次运行带来的新覆盖数量,不修改累计覆盖率
+        size_t novelty(const uint8_t *trace) const;
+        // 合并一次运行的位图,返回新覆盖的数量
+        size_t merge(const uint8_t *trace);
+        // 已经覆盖的边数量
+        size_t edges() const;
+        // 读取累计覆盖率,文件不存在或大小不符时返回false
+        bool load(const fs::path &file);
+        // 保存累计覆盖率
+        void save(const fs::path &file) const;
+        // 运行时桩代码,与 -fsanitize-coverage=trace-pc 编译的源文件一起编译
+        static string runtime();
+    };
+}
+
+#endif // COVERAGE_H
@@ -0,0 +1,25 @@
+#ifndef DIAGNOSIS_H
+#define DIAGNOSIS_H
+
+#include <vector>
+#include <map>
+#include "Self.h"
+
+namespace acm{
+    // 失败样例的诊断工具,快速路径不使用,只在复现失败样例时调用
+    class Diagnosis{
+    public:
+        // 消毒器编译选项,追加在测试代码的编译选项后面
+        static std::vector<string> sanitizer_flags();
+        // 消毒器运行时的环境变量
+        static std::map<string,string> sanitizer_env();
+        // 从消毒器输出中提取第一个错误和调用栈,没有错误时返回空字符串
+        static string sanitizer_report(const string &output,size_t frames=16);
+        // 从 massif 输出文件内容中提取峰值快照,没有峰值快照时返回空字符串
+        static string massif_report(const string &content,size_t lines=16);
+        // 在 PATH 中查找程序,找不到时返回空路径
+        static fs::path which(const string &name);
+    };
+}
+
+#endif // DIAGNOSIS_H
@@ -0,0 +1,17 @@
+#ifndef HASH_H
+#define HASH_H
+
+#include <cstdint>
+#include <string_view>
+#include "Self.h"
+
+namespace acm{
+    // FNV-1a 64位哈希,用于内容指纹,不用于安全场景
+    uint64_t hash_bytes(std::string_view data,uint64_t seed=0xcbf29ce484222325ull);
+    // 文件内容哈希,文件不存在时返回0
+    uint64_t hash_file(const fs::path &file,uint64_t seed=0xcbf29ce484222325ull);
+    // 转换为16位十六进制字符串
+    string to_hex(uint64_t value);
+}
+
+#endif // HASH_H
@@ -0,0 +1,47 @@
+#ifndef JOURNAL_H
+#define JOURNAL_H
+
+#include "Self.h"
+#include "json.hpp"
+
+namespace acm{
+    using nlohmann::json;
+    // 追加式进度日志
+    // 每条记录为一行JSON对象,回放时按顺序覆盖到配置上
+    class Journal{
+        // 日志文件路径
+        fs::path _filePath;
+        // 文件描述符
+        int _fd=-1;
+        // 当前记录条数
+        size_t _entries=0;
+        // 压缩阈值
+        size_t _compactLimit=256;
+        // 打开日志文件
+        void open();
+    public:
+        // 构造函数
+        Journal();
+        Journal(const fs::path &file);
+        Journal(const Journal &)=delete;
+        Journal &operator=(const Journal &)=delete;
+        // 设置路径
+        void set_path(const fs::path &file);
+        // 设置压缩阈值
+        void set_compact(size_t limit);
+        // 追加一条记录
+        void append(const json &entry);
+        // 回放日志到数据中,返回回放的记录条数
+        size_t replay(json &data);
+        // 是否需要压缩
+        bool need_compact() const;
+        // 清空日志,在检查点写入之后调用
+        void clear();
+        // 记录条数
+        size_t size() const;
+        // 析构函数
+        ~Journal();
+    };
+}
+
+#endif // JOURNAL_H
@@ -0,0 +1,46 @@
+#ifndef MUTATOR_H
+#define MUTATOR_H
+
+#include "Tokens.h"
+#include "Random.h"
+
+namespace acm{
+    // 按行和空白结构变异测试数据
+    // 每个变异叠加1~4次操作: 数字推向边界、交换或复制元素和行、与另一个输入拼接,复制元素和行时尝试同时修正数量头
+    // 变异结果不保证合法,需要由验证器过滤
+    class Mutator{
+        // 种子语料
+        std::vector<Tokens> _corpus;
+        // 随机数
+        CounterRng _rng;
+        // 语料中出现过的整数范围
+        long long _min=0;
+        long long _max=0;
+        bool _hasNumber=false;
+        // 随机选择一个整数推向边界
+        bool boundary(Tokens &tokens);
+        // 交换同一行的两个元素
+        bool swap_tokens(Tokens &tokens);
+        // 复制一个元素
+        bool duplicate_token(Tokens &tokens);
+        // 交换两行
+        bool swap_lines(Tokens &tokens);
+        // 复制一行
+        bool duplicate_line(Tokens &tokens);
+        // 与另一个输入拼接
+        bool splice(Tokens &tokens);
+        // 把等于 oldCount 的数量头加上 delta,依次查找前一行和同一行开头
+        static bool adjust_count(Tokens &tokens,size_t line,long long oldCount,long long delta);
+    public:
+        // 构造函数,相同的密钥和语料得到相同的变异序列
+        explicit Mutator(uint64_t key);
+        // 添加种子输入
+        void add(const string &input);
+        // 种子数量
+        size_t size() const;
+        // 生成一个变异,没有种子时返回空
+        string mutate();
+    };
+}
+
+#endif // MUTATOR_H
@@ -20,7 +20,7 @@ namespace process{
     class Pipe{
     private:
         // 管道句柄
-        Handle _pipe[2];
+        Handle _pipe[2]={ -1,-1 };
         // 管道阻塞信号
         int _flags;
         // 管道类型 1 为写，0 为读
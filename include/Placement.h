@@ -0,0 +1,51 @@
+#ifndef PLACEMENT_H
+#define PLACEMENT_H
+
+#include <vector>
+#include <mutex>
+#include <condition_variable>
+#include "Self.h"
+
+namespace acm{
+    // CPU分配
+    // 计时运行独占计时CPU,每个物理核心只用一个逻辑CPU,它的SMT兄弟空闲;
+    // 生成器、验证器、检查器、编译器和AI客户端使用辅助CPU
+    class Placement{
+        // 每个物理核心的逻辑CPU
+        std::vector<std::vector<int>> _cores;
+        // 计时CPU和辅助CPU
+        std::vector<int> _solution;
+        std::vector<int> _helper;
+        // 计时CPU是否被占用
+        std::vector<bool> _busy;
+        std::mutex _lock;
+        std::condition_variable _free;
+        // 所在物理核心的下标,不存在时返回-1
+        int core_of(int cpu) const;
+    public:
+        // 解析 "0-3,8" 格式的CPU列表
+        static std::vector<int> parse_list(const string &list);
+        // 读取允许的CPU的SMT拓扑,按物理核心分组,读取失败时每个CPU单独一组
+        static std::vector<std::vector<int>> topology(const std::vector<int> &allowed,const fs::path &sysfs="/sys/devices/system/cpu");
+        // 设置拓扑和分配,solution 为空时自动分配: 一半的物理核心(至少一个)用于计时,只有一个核心时两者共用;
+        // 只指定 helper 时保留它,计时CPU取自不含辅助CPU的核心;
+        // 分配中有拓扑之外的CPU时抛出异常
+        void configure(const std::vector<std::vector<int>> &cores,const std::vector<int> &solution={},const std::vector<int> &helper={});
+        // 计时CPU
+        const std::vector<int> &solution() const;
+        // 辅助CPU
+        const std::vector<int> &helper() const;
+        // 计时CPU是否与辅助CPU或其他计时CPU共用物理核心
+        bool shared() const;
+        // 占用一个空闲的计时CPU,没有时等待,没有计时CPU时返回-1
+        int acquire();
+        // 释放计时CPU
+        void release(int cpu);
+        // 把调用线程绑定到辅助CPU,之后创建的线程和子进程继承
+        bool bind_helper() const;
+        // 分配说明
+        string report() const;
+    };
+}
+
+#endif // PLACEMENT_H
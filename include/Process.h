@@ -5,9 +5,15 @@
 #include "Timer.h"
 #include "Args.h"
 #include "Pipe.h"
+#include "Counters.h"
 #include <iostream>
 #include <sstream>
 #include <map>
+#include <vector>
+#include <chrono>
+#include <atomic>
+#include <mutex>
+#include <sys/resource.h>
 
 
 namespace process{
@@ -30,7 +36,10 @@ namespace process{
         // 子进程信息传递控制管道
         Pipe _child_message;
         // pid
-        pid_t _pid=-1;
+        std::atomic<pid_t> _pid=-1;
+        // 子进程是否已经结束,计时器只在结束前发送终止信号
+        std::mutex _exitLock;
+        bool _exited=false;
         // 路径
         string _path;
         string name="Process";
@@ -42,12 +51,23 @@ namespace process{
         int _memsize=0;
         // 时间超限
         int _timelimit=0;
+        // 绑定的CPU,为空时不绑定
+        std::vector<int> _cpus;
+        // 是否记录性能计数器
+        bool _counting=false;
+        // 性能计数器和子进程结束时的计数
+        Counters _counters;
+        CounterValues _counterValues;
         // 输出是否空
         bool _empty=true;
         // 是否启用颜色
         bool _enable_color=false;
         // 退出状态
         int _exit_code=-1;
+        // 资源使用情况
+        struct rusage _usage{};
+        // 启动和结束时间
+        std::chrono::steady_clock::time_point _startTime,_endTime;
         // 缓冲区大小
         int _buffer_size=4096;
         // 非阻塞超时
@@ -77,6 +97,16 @@ namespace process{
         int get_exit_code() const;
         // 获得退出状态
         Status get_status() const;
+        // 获得CPU时间(ms),用户态加内核态
+        int get_time() const;
+        // 获得CPU时间(us)
+        long long get_time_us() const;
+        // 获得墙钟时间(ms)
+        int get_wall_time() const;
+        // 获得峰值内存(KB)
+        long get_memory() const;
+        // 获得性能计数器的值
+        const CounterValues &get_counters() const;
         // 读取数据
         string read(PipeType type=PIPE_OUT,size_t nbytes=0);
         // 读取到文件
@@ -89,6 +119,8 @@ namespace process{
         string getline(char delimiter='\n');
         // 读错误
         string get_error(size_t nbytes=0);
+        // 读完整的错误输出,保留换行
+        string get_report();
         // 读字符
         char getchar();
         // 刷新输入
@@ -130,6 +162,13 @@ namespace process{
         // 取消内存限制
         Process &cancel_memout();
 
+        // 把子进程绑定到指定的CPU
+        Process &set_affinity(const std::vector<int> &cpus);
+        // 当前进程允许运行的CPU
+        static std::vector<int> allowed_cpus();
+        // 记录子进程的性能计数器,子进程在计数器打开后才 exec
+        Process &set_counters(bool enable);
+
         // 重载运算符
         template<typename T>
         Process &operator<<(const T &data){
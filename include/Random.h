@@ -0,0 +1,33 @@
+#ifndef RANDOM_H
+#define RANDOM_H
+
+#include <cstdint>
+#include <vector>
+#include "Self.h"
+
+namespace acm{
+    // 随机流编号,同一测试点的不同用途互不相关
+    enum RandomStream{ Stream_Seed=1,Stream_Mode=2,Stream_Hunt=3,Stream_Scale=4,Stream_Coverage=5,Stream_Mutate=6,Stream_Bandit=7,Stream_Calibrate=8 };
+    // SplitMix64 混合函数
+    uint64_t splitmix64(uint64_t x);
+    // 由主种子、测试点编号和随机流派生子密钥,结果只取决于参数
+    uint64_t derive(uint64_t master,uint64_t index,uint64_t stream);
+    // 计数器随机数发生器,第n个输出为 splitmix64(key+n*gamma)
+    class CounterRng{
+        uint64_t _key;
+        uint64_t _counter=0;
+    public:
+        // 构造函数
+        explicit CounterRng(uint64_t key);
+        // 下一个随机数
+        uint64_t next();
+        // [0,bound) 范围内的随机数
+        uint64_t below(uint64_t bound);
+    };
+    // 按权重选择下标,draw 为任意随机数
+    int weighted_index(const std::vector<int> &weights,uint64_t draw);
+    // 生成新的主种子
+    uint64_t random_master();
+}
+
+#endif // RANDOM_H
@@ -0,0 +1,48 @@
+#ifndef REDUCER_H
+#define REDUCER_H
+
+#include <vector>
+#include <functional>
+#include <atomic>
+#include "Tokens.h"
+
+namespace acm{
+    // 测试数据最小化
+    // 按 ddmin 的方式依次尝试删除行、删除行内元素(同时修正数量头)和缩小数字,
+    // 每一轮的候选数据并行交给判定函数,取编号最小的有效候选,结果与线程数无关
+    class Reducer{
+    public:
+        // 判定函数,候选数据仍然合法且能复现错误时返回true,会在多个线程中同时调用
+        using Oracle=std::function<bool(const string &)>;
+    private:
+        // 判定函数
+        Oracle _oracle;
+        // 并行数量
+        int _jobs=1;
+        // 判定次数上限
+        size_t _budget=1000;
+        // 已经判定的次数
+        std::atomic<size_t> _tests{ 0 };
+        // 并行判定候选,返回第一个有效候选的下标,没有时返回-1
+        int first(const std::vector<Tokens> &candidates);
+        // 删除行
+        bool reduce_lines(Tokens &tokens);
+        // 删除行内元素
+        bool reduce_elements(Tokens &tokens);
+        // 缩小数字
+        bool reduce_numbers(Tokens &tokens);
+        // 删除元素后修正数量头,返回所有可能的修正
+        static std::vector<Tokens> fix_counts(const Tokens &tokens,size_t line,long removed,long oldCount);
+    public:
+        // 构造函数
+        Reducer(Oracle oracle,int jobs=1);
+        // 设置判定次数上限
+        void set_budget(size_t budget);
+        // 已经判定的次数
+        size_t tests() const;
+        // 最小化,输入必须满足判定函数
+        string reduce(const string &data);
+    };
+}
+
+#endif // REDUCER_H
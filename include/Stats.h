@@ -0,0 +1,31 @@
+#ifndef STATS_H
+#define STATS_H
+
+#include <vector>
+#include <cstddef>
+
+namespace acm{
+    // 中位数,空数组返回0
+    double median(std::vector<double> values);
+    // 学生t分布的0.975分位数,用于95%置信区间
+    double t_975(size_t df);
+    // 最小二乘直线拟合 y=slope*x+intercept
+    struct LinearFit{
+        double slope=0;
+        double intercept=0;
+        // 斜率的标准误
+        double slopeError=0;
+        // 决定系数
+        double r2=0;
+        // 点数
+        size_t n=0;
+        // 斜率95%置信区间的半宽,点数不足时为无穷大
+        double half_width() const;
+        // 预测值
+        double predict(double x) const;
+    };
+    // 拟合,点数少于2时返回空结果
+    LinearFit linear_fit(const std::vector<double> &x,const std::vector<double> &y);
+}
+
+#endif // STATS_H
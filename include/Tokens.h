@@ -0,0 +1,18 @@
+#ifndef TOKENS_H
+#define TOKENS_H
+
+#include <vector>
+#include "Self.h"
+
+namespace acm{
+    // 按行按空白切分的测试数据
+    typedef std::vector<std::vector<string>> Tokens;
+    // 切分,空行保留为空的一行
+    Tokens split_tokens(const string &data);
+    // 拼接,元素之间一个空格,每行以换行结尾
+    string join_tokens(const Tokens &tokens);
+    // 是否为不超过18位的整数
+    bool is_integer(const string &token);
+}
+
+#endif // TOKENS_H
@@ -62,7 +62,63 @@ bool have_test_files(fs::path testPath){
     return true;
 }
 
-int main(){
+// 命令模式: ./main <命令> <测试文件夹> [参数]
+int run_command(int argc,char *argv[]){
+    string command=argv[1];
+    fs::path path=argv[2];
+    acm::AutoTest test;
+    if(!test.load(path)){
+        return EXIT_FAILURE;
+    }
+    // 导出打包数据为松散文件,默认导出到测试文件夹
+    if(command=="export"){
+        fs::path target=(argc>3)?fs::path(argv[3]):path;
+        return test.export_data(target)?EXIT_SUCCESS:EXIT_FAILURE;
+    }
+    // 重放全部测试点, --stop-first 遇到第一个错误时停止
+    if(command=="replay"){
+        bool stopFirst=argc>3&&string(argv[3])=="--stop-first";
+        return test.replay(stopFirst)?EXIT_SUCCESS:EXIT_FAILURE;
+    }
+    // 搜索使测试代码最慢的输入,可以指定搜索轮数
+    if(command=="hunt"){
+        int rounds=(argc>3)?std::atoi(argv[3]):0;
+        return test.hunt(rounds)?EXIT_SUCCESS:EXIT_FAILURE;
+    }
+    // 覆盖率引导的输入选择,可以指定运行次数
+    if(command=="coverage"){
+        int execs=(argc>3)?std::atoi(argv[3]):0;
+        return test.coverage(execs)?EXIT_SUCCESS:EXIT_FAILURE;
+    }
+    // 变异错误样例和已保存的输入,可以指定变异数量
+    if(command=="mutate"){
+        int count=(argc>3)?std::atoi(argv[3]):0;
+        return test.mutate(count)?EXIT_SUCCESS:EXIT_FAILURE;
+    }
+    // 校准时间限制并给出建议的时间、内存限制
+    if(command=="calibrate"){
+        return test.calibrate()?EXIT_SUCCESS:EXIT_FAILURE;
+    }
+    // 估计测试代码和AC代码的复杂度
+    if(command=="complexity"){
+        return test.complexity()?EXIT_SUCCESS:EXIT_FAILURE;
+    }
+    // 最小化错误样例集合并推送到CPH
+    if(command=="minimize"){
+        return test.minimize_failures()?EXIT_SUCCESS:EXIT_FAILURE;
+    }
+    // 监视测试代码,保存后重新编译并重放错误样例
+    if(command=="watch"){
+        return test.watch()?EXIT_SUCCESS:EXIT_FAILURE;
+    }
+    std::cerr<<"未知命令: "<<command<<std::endl;
+    return EXIT_FAILURE;
+}
+
+int main(int argc,char *argv[]){
+    if(argc>=3){
+        return run_command(argc,argv);
+    }
     acm::AutoTest test;
     // 是否进行一些基础的配置
     std::string config;
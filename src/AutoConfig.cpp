@@ -1,4 +1,7 @@
 #include "AutoConfig.h"
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
 
 namespace acm{
     // 配置转换器
@@ -66,6 +69,80 @@ namespace acm{
             return "test_weight";
         case Weights:
             return "weights";
+        case Storage:
+            return "storage";
+        case Retention:
+            return "retention";
+        case KeepSlowest:
+            return "keep_slowest";
+        case MasterSeed:
+            return "master_seed";
+        case ShardCount:
+            return "shard_count";
+        case ShardIndex:
+            return "shard_index";
+        case CacheLimit:
+            return "cache_limit";
+        case CompileJobs:
+            return "compile_jobs";
+        case Minimize:
+            return "minimize";
+        case MinimizeBudget:
+            return "minimize_budget";
+        case HuntRounds:
+            return "hunt_rounds";
+        case HuntPopulation:
+            return "hunt_population";
+        case PerfKeep:
+            return "perf_keep";
+        case ComplexityPoints:
+            return "complexity_points";
+        case ComplexityRepeat:
+            return "complexity_repeat";
+        case CoverageExecs:
+            return "coverage_execs";
+        case MutateCount:
+            return "mutate_count";
+        case Scheduler:
+            return "scheduler";
+        case TimeScale:
+            return "time_scale";
+        case ApplyTimeScale:
+            return "apply_time_scale";
+        case AutoCalibrate:
+            return "auto_calibrate";
+        case CalibrateRepeat:
+            return "calibrate_repeat";
+        case CalibrateReference:
+            return "calibrate_reference_us";
+        case RetimeCount:
+            return "retime_count";
+        case RetimeMargin:
+            return "retime_margin";
+        case RetimeNoise:
+            return "retime_noise";
+        case ContinueOnFailure:
+            return "continue_on_failure";
+        case PerfCounters:
+            return "perf_counters";
+        case InstructionBudget:
+            return "instruction_budget";
+        case CorePlacement:
+            return "core_placement";
+        case CoreMap:
+            return "core_map";
+        case Diagnose:
+            return "diagnose";
+        case References:
+            return "references";
+        case ToolTimeLimit:
+            return "tool_time_limit";
+        case ToolMemLimit:
+            return "tool_mem_limit";
+        case MaxRejections:
+            return "max_rejections";
+        case RegenerateTools:
+            return "regenerate_tools";
         default:
             throw std::runtime_error("未知配置项");
         }
@@ -115,13 +192,30 @@ namespace acm{
         return fileSize!=(size_t)0;
     }
     // 保存到配置文件
+    // 先写入临时文件并落盘,再原子重命名覆盖,中途被杀不会损坏原文件
     void AutoConfig::save(size_t dumpNum){
-        std::ofstream file(_filePath,std::ios::out);
-        if(!file.is_open()){
-            throw std::runtime_error("AutoConfig: 无法打开文件: "+_filePath.string());
+        fs::path tempPath=_filePath;
+        tempPath+=".tmp";
+        int fd=::open(tempPath.c_str(),O_WRONLY|O_CREAT|O_TRUNC|O_CLOEXEC,0644);
+        if(fd==-1){
+            throw std::runtime_error("AutoConfig: 无法打开文件: "+tempPath.string());
         }
-        file<<_data.dump(dumpNum);
-        file.close();
+        string content=_data.dump(dumpNum);
+        const char *data=content.data();
+        size_t left=content.size();
+        while(left>0){
+            ssize_t n=::write(fd,data,left);
+            if(n<0){
+                if(errno==EINTR) continue;
+                ::close(fd);
+                throw std::runtime_error("AutoConfig: 写入失败: "+tempPath.string());
+            }
+            data+=n;
+            left-=n;
+        }
+        ::fsync(fd);
+        ::close(fd);
+        fs::rename(tempPath,_filePath);
     }
     // 获取原数据
     json &AutoConfig::value(){
@@ -2,7 +2,19 @@
 #include "AutoTest.h"
 #include "AutoJson.h"
 #include "Judge.h"
+#include "Hash.h"
+#include "Random.h"
+#include "Reducer.h"
+#include "Stats.h"
+#include "Coverage.h"
+#include "Mutator.h"
+#include "Diagnosis.h"
 #include "fstream"
+#include <atomic>
+#include <mutex>
+#include <set>
+#include <poll.h>
+#include <sys/inotify.h>
 
 namespace acm{
     void AutoTest::wfile(const fs::path &path,const string &code){
@@ -396,8 +408,40 @@ namespace acm{
                 { "max_tokens",4096 },
                 { "top_p",1 }
             };
+            // 编译缓存大小上限(MB)
+            _setting[f(CacheLimit)]=1024;
+            // 同时编译的数量,0 为CPU核心数
+            _setting[f(CompileJobs)]=0;
             _setting.save();
         }
+        // 编译缓存在多个题目文件夹之间共享
+        _compiler.set_cache(_path/"cache");
+        _compiler.set_limit(_setting.value().value(f(CacheLimit),1024ull)<<20);
+        int jobs=_setting.value().value(f(CompileJobs),0);
+        _compiler.set_jobs(jobs>0?jobs:(int)std::thread::hardware_concurrency());
+    }
+    // 默认编译配置,解答与常见评测机一致使用 -O2
+    static json default_profiles(){
+        json solution={
+            { "std","c++17" },
+            { "flags",{ "-O2" } },
+            { "defines",{ "ONLINE_JUDGE" } },
+            { "link",json::array() }
+        };
+        // 工具优先编译速度
+        json tool={
+            { "std","c++17" },
+            { "flags",json::array() },
+            { "defines",json::array() },
+            { "link",json::array() }
+        };
+        return {
+            { "solution",solution },
+            { "reference",solution },
+            { "generator",tool },
+            { "validator",tool },
+            { "checker",tool }
+        };
     }
     // 测试配置初始化
     void AutoTest::init_test_config(){
@@ -432,6 +476,63 @@ namespace acm{
             _config["weights"][0]=10;
             _config["weights"][1]=1;
             _config["weights"][2]=2;
+            // 数据存储方式 packed 打包存储 loose 松散文件
+            _config[f(Storage)]="packed";
+            // 数据保留策略 full 保存全部数据 seed 通过的测试点只保存种子
+            _config[f(Retention)]="full";
+            // seed 策略下额外保留最慢的测试点数量
+            _config[f(KeepSlowest)]=16;
+            // 主种子,相同主种子生成相同的测试点
+            _config[f(MasterSeed)]=to_hex(random_master());
+            // 分片数量和当前分片编号
+            _config[f(ShardCount)]=1;
+            _config[f(ShardIndex)]=0;
+            // 发现错误时最小化错误样例,以及最小化的判定次数上限
+            _config[f(Minimize)]=true;
+            _config[f(MinimizeBudget)]=1000;
+            // 性能搜索的轮数、每轮候选数量和性能语料保留的数量
+            _config[f(HuntRounds)]=20;
+            _config[f(HuntPopulation)]=8;
+            _config[f(PerfKeep)]=8;
+            // 复杂度估计的规模数量和每个规模的重复次数
+            _config[f(ComplexityPoints)]=7;
+            _config[f(ComplexityRepeat)]=5;
+            // 覆盖率引导模式的运行次数
+            _config[f(CoverageExecs)]=2000;
+            // 变异模式生成的变异数量
+            _config[f(MutateCount)]=200;
+            // 生成参数的自适应调度策略,为空时使用 weights 或 special/edge
+            _config[f(Scheduler)]="";
+            // 校准建议的时间限制倍率,只有开启 apply_time_scale 时才用于判题;主机改变时自动校准,以及校准时每组数据的重复次数
+            _config[f(TimeScale)]=1.0;
+            _config[f(ApplyTimeScale)]=false;
+            _config[f(AutoCalibrate)]=true;
+            _config[f(CalibrateRepeat)]=5;
+            // 参考机器上固定负载的CPU时间(us),默认为约3GHz的x86核心上的用时,可以改为评测机上 calibration.json 的 benchmark_us
+            _config[f(CalibrateReference)]=40000.0;
+            // 用时在时间限制的 retime_margin 以内或超时的运行重复计时的次数,以及判定计时不稳定的波动
+            _config[f(RetimeCount)]=5;
+            _config[f(RetimeMargin)]=0.2;
+            _config[f(RetimeNoise)]=0.2;
+            // 测试代码超时或运行错误时默认中止对拍
+            _config[f(ContinueOnFailure)]=false;
+            // 记录性能计数器,以及按指令数判定超时的预算(0 为不限制)
+            _config[f(PerfCounters)]=false;
+            _config[f(InstructionBudget)]=0;
+            // 计时运行独占计时CPU,其他进程使用辅助CPU;会把主进程绑定到部分核心,需要手动开启;core_map 为空时自动分配
+            _config[f(CorePlacement)]=false;
+            _config[f(CoreMap)]=json::object();
+            // 失败的样例用消毒器版本和内存分析重新运行,诊断报告保存到错误样例
+            _config[f(Diagnose)]=true;
+            // 额外的参考解,如 {"name": "brute", "file": "brute.cpp", "max_input_bytes": 1000, "time_limit": 10000}
+            _config[f(References)]=json::array();
+            // 生成器和验证器每次运行的预算,同一测试点连续被拒绝的上限,超出时是否让AI按统计重新生成工具
+            _config[f(ToolTimeLimit)]=10000;
+            _config[f(ToolMemLimit)]=1024;
+            _config[f(MaxRejections)]=50;
+            _config[f(RegenerateTools)]=false;
+            // 各角色的编译配置
+            _config["compile_profiles"]=default_profiles();
             // 工具调用
             _config["tool_choice"]="auto";
             // 路径
@@ -449,6 +550,45 @@ namespace acm{
             _config.save();
         }
     }
+    // 初始化进度日志
+    void AutoTest::init_journal(){
+        _journal.set_path(_baseConfigPath/"progress.journal");
+        size_t count=_journal.replay(_config.value());
+        if(count>0){
+            _testlog.tlog("从进度日志恢复了"+std::to_string(count)+"条记录");
+            checkpoint();
+        }
+    }
+    // 记录进度
+    void AutoTest::progress(const json &entry){
+        _config.value().update(entry);
+        _journal.append(entry);
+        if(_journal.need_compact()){
+            checkpoint();
+        }
+    }
+    // 写入检查点
+    void AutoTest::checkpoint(){
+        // 先原子写入配置,再清空日志,两步之间中断回放也是幂等的
+        _config.save();
+        _journal.clear();
+        save_stats();
+    }
+    // 写入内存中的运行统计,每个测试点都写文件会带来额外的 fsync
+    void AutoTest::save_stats(){
+        if(_toolStatsDirty){
+            _toolStats.save();
+            _toolStatsDirty=false;
+        }
+        if(_banditDirty){
+            _banditState.save();
+            _banditDirty=false;
+        }
+        if(_referenceDirty){
+            _referenceState.save();
+            _referenceDirty=false;
+        }
+    }
     // 初始化文档读取
     void AutoTest::init_docs(const fs::path &path){
         if(!fs::exists(path)){
@@ -517,6 +657,7 @@ namespace acm{
         _log(_path){
         // 设置日志总配置
         _log.set_logName("AutoTest.log");
+        _log.set_async(true);
         _log.tlog("AutoTest开始运行");
         // 配置文件初始化
         init_config();
@@ -733,6 +874,43 @@ namespace acm{
     }
     // 初始化共有
     bool AutoTest::init_temp(){
+        // 旧文件夹没有主种子时生成一个并保存
+        if(_config[f(MasterSeed)].is_null()){
+            _config[f(MasterSeed)]=to_hex(random_master());
+            checkpoint();
+        }
+        if(_config[f(MasterSeed)].is_number()){
+            _master=_config[f(MasterSeed)].get<uint64_t>();
+        }
+        else{
+            try{
+                _master=std::stoull(_config[f(MasterSeed)].get<string>(),nullptr,16);
+            }
+            catch(const std::exception &e){
+                _testlog.tlog("主种子格式错误,应为十六进制字符串: "+_config[f(MasterSeed)].dump(),loglib::ERROR);
+                return false;
+            }
+        }
+        // 旧文件夹补全编译配置
+        if(!_config["compile_profiles"].is_object()){
+            _config["compile_profiles"]=default_profiles();
+            checkpoint();
+        }
+        _shardCount=_config.value().value(f(ShardCount),1);
+        _shardIndex=_config.value().value(f(ShardIndex),0);
+        _retimeCount=_config.value().value(f(RetimeCount),5);
+        _retimeMargin=_config.value().value(f(RetimeMargin),0.2);
+        _retimeNoise=_config.value().value(f(RetimeNoise),0.2);
+        _toolTime=_config.value().value(f(ToolTimeLimit),10000);
+        _toolMemory=_config.value().value(f(ToolMemLimit),1024);
+        if(_shardCount<1||_shardIndex<0||_shardIndex>=_shardCount){
+            _testlog.tlog("分片配置错误: shard_index 应在 [0,shard_count) 范围内",loglib::ERROR);
+            return false;
+        }
+        if(!init_scheduler()||!init_placement()||!init_references()){
+            return false;
+        }
+        _toolStats.set_path(_baseConfigPath/"tool_stats.json");
         // 初始化dataDirs
         if(_dataDirs.empty()){
             // 初始化数据文件夹
@@ -741,11 +919,51 @@ namespace acm{
                 _basePath/"outData",
                 _basePath/"acData"
             };
+            // 旧文件夹没有存储方式配置时沿用松散文件
+            if(_config[f(Storage)].is_null()){
+                _config[f(Storage)]=fs::exists(_dataDirs[inData])?"loose":"packed";
+            }
+            _packed=_config[f(Storage)]=="packed";
+            if(_config[f(Retention)].is_null()){
+                _config[f(Retention)]="full";
+            }
+            if(_config[f(KeepSlowest)].is_null()){
+                _config[f(KeepSlowest)]=16;
+            }
+            _seedOnly=_packed&&_config[f(Retention)]=="seed";
+            if(!_packed&&_config[f(Retention)]=="seed"){
+                _testlog.tlog("松散文件存储不支持seed保留策略,将保存全部数据",loglib::WARNING);
+            }
+            if(_packed){
+                fs::path corpusPath=_basePath/"corpus";
+                bool corpusExist=Corpus::exists(corpusPath);
+                _corpus.open(corpusPath);
+                _workPath=_basePath/"work";
+                fs::create_directories(_workPath);
+                _workData=0;
+                if(!corpusExist){
+                    // 从松散文件迁移
+                    size_t count=_corpus.import_from(_dataDirs);
+                    if(count>0){
+                        _testlog.tlog("已将"+std::to_string(count)+"个松散测试点导入语料库");
+                    }
+                    else{
+                        // 初始化测试数量
+                        _config[f(NowData)]=0;
+                        _config[f(NowTest)]=0;
+                        _config["slowest"]=json::array();
+                        checkpoint();
+                    }
+                }
+                // 初始化临时存储数字
+                _temp_config=_config.value();
+                return true;
+            }
             if(!fs::exists(_dataDirs[0])){
                 // 初始化测试数量
                 _config[f(NowData)]=0;
                 _config[f(NowTest)]=0;
-                _config.save();
+                checkpoint();
             }
             for(const auto &dir:_dataDirs){
                 if(!fs::exists(dir)){
@@ -793,9 +1011,12 @@ namespace acm{
         // 初始化日志
         _testlog.set_logPath(_basePath);
         _testlog.set_logName("test.log");
+        _testlog.set_async(true);
+        _testlog.set_rotate(16*1024*1024);
         _testlog.tlog("测试日志开始运行");
         // 初始化测试配置
         init_test_config();
+        init_journal();
         // 重设需要的文件路径
         _problemfile=_basePath/"problem.md";
         _testfile=_basePath/"test.cpp";
@@ -820,7 +1041,10 @@ namespace acm{
             fs::create_directories(_baseProgramPath);
         }
         // 初始化其他配置
-        init_temp();
+        if(!init_temp()){
+            return false;
+        }
+        check_depend();
         _log.tlog("初始化成功,文件夹在: "+_basePath.string());
         return true;
     }
@@ -845,6 +1069,8 @@ namespace acm{
             _name=path.filename().string();
             init_test_config();
         }
+        // 回放进度日志
+        init_journal();
         // 读取配置项
         _name=_config[f(Test_Name)];
         // 读取题目
@@ -868,6 +1094,8 @@ namespace acm{
         // 读入日志文件
         _testlog.set_logPath(_basePath);
         _testlog.set_logName("test.log");
+        _testlog.set_async(true);
+        _testlog.set_rotate(16*1024*1024);
         // 初始化AI - 构造
         string tempURL=_setting[f(OpenAI_URL)];
         if(!_config[f(Attach_Global)]){
@@ -900,11 +1128,14 @@ namespace acm{
         _log.tlog("载入"+_name+"成功");
         _testlog.tlog("重新载入成功");
         // 初始化其他配置
-        init_temp();
+        if(!init_temp()){
+            return false;
+        }
+        check_depend();
         return true;
     }
     // 测试工具生成编译
-    bool AutoTest::make(ConfigSign name,json &session){
+    bool AutoTest::make(ConfigSign name,json &session,const string &hint){
         string nameStr;
         switch(name){
         case Generators:
@@ -929,6 +1160,9 @@ namespace acm{
         fs::path targetPath=_baseProgramPath/targetName;
         fs::path srcPath=_basePath/srcName;
         string prompt=_prompt[f(name)];
+        if(!hint.empty()){
+            prompt+="\n"+hint;
+        }
         // 重试次数
         int tryNums=0;
         while(true){
@@ -968,20 +1202,17 @@ namespace acm{
             }
             // 编译文件
             // 如果已经编译则不需要再编译，但是前提是前面不需要重新生成源代码
-            if(srcExist&&fs::exists(targetPath)){
+            if(srcExist&&up_to_date(name,srcPath)&&!pending(name)){
                 _testlog.tlog(nameStr+"编译文件已经存在");
                 return true;
             }
             else{
                 _testlog.tlog("正在编译"+nameStr);
-                process::Args args("g++");
-                args.add(srcPath).add("-o").add(targetPath);
-                process::Process proc("/bin/g++",args);
-                proc.start();
-                process::Status status=proc.wait();
-                string error=proc.get_error();
+                // 源文件已经存在时取回后台编译的结果
+                CompileResult res=ensure(name,srcPath);
+                string error=res.error;
                 // 如果不是正常退出输出错误信息
-                if(status!=process::STOP){
+                if(!res.ok){
                     _testlog.tlog(nameStr+"编译失败,编译错误信息: \n"+error,loglib::ERROR);
                     if(tryNums>=3){
                         _testlog.tlog("编译失败次数过多,请检查提示词",loglib::ERROR);
@@ -999,6 +1230,258 @@ namespace acm{
         }
         return true;
     }
+    // 编译源文件到可执行文件
+    CompileResult AutoTest::compile(const fs::path &src,const fs::path &target,const std::vector<string> &flags){
+        std::vector<string> pch;
+        // 引用 testlib.h 且与 config/testlib.h 一致时使用预编译头文件
+        fs::path testlib=src.parent_path()/"testlib.h";
+        std::ifstream file(src);
+        string code((std::istreambuf_iterator<char>(file)),std::istreambuf_iterator<char>());
+        if(code.find("testlib.h")!=string::npos&&
+            hash_file(testlib)!=0&&hash_file(testlib)==hash_file(_path/"testlib.h")){
+            // 预编译头文件必须使用相同的编译参数
+            pch=_compiler.precompile(_path/"testlib.h",flags);
+        }
+        std::vector<string> args=pch;
+        args.insert(args.end(),flags.begin(),flags.end());
+        CompileResult res=_compiler.compile(src,target,args);
+        res.pch=!pch.empty();
+        return res;
+    }
+    // 目标对应的编译配置角色
+    string AutoTest::role(ConfigSign name){
+        switch(name){
+        case Test_Code:
+            return "solution";
+        case AC_Code:
+            return "reference";
+        case Generators:
+            return "generator";
+        case Validators:
+            return "validator";
+        case Checkers:
+            return "checker";
+        default:
+            throw std::runtime_error("AutoTest: 没有对应的编译配置: "+f(name));
+        }
+    }
+    // 目标的编译参数
+    std::vector<string> AutoTest::profile(ConfigSign name){
+        json config=_config["compile_profiles"].value(role(name),json::object());
+        std::vector<string> flags;
+        if(config.contains("std")){
+            flags.push_back("-std="+config["std"].get<string>());
+        }
+        for(const auto &flag:config.value("flags",json::array())){
+            flags.push_back(flag.get<string>());
+        }
+        for(const auto &define:config.value("defines",json::array())){
+            flags.push_back("-D"+define.get<string>());
+        }
+        // 链接参数放在源文件之后
+        for(const auto &flag:config.value("link",json::array())){
+            flags.push_back(flag.get<string>());
+        }
+        return flags;
+    }
+    // 目标的版本键
+    uint64_t AutoTest::binary_key(ConfigSign name,const fs::path &src){
+        return _compiler.key(src,profile(name));
+    }
+    // 目标的源文件键
+    uint64_t AutoTest::source_key(ConfigSign name,const fs::path &src){
+        return _compiler.source_key(src,profile(name));
+    }
+    // 可执行文件是否存在且与源文件和编译参数一致
+    bool AutoTest::up_to_date(ConfigSign name,const fs::path &src){
+        fs::path target=_baseProgramPath/f(name);
+        if(!fs::exists(target)){
+            return false;
+        }
+        std::ifstream stamp(target.string()+".key");
+        string key;
+        stamp>>key;
+        return key==to_hex(binary_key(name,src));
+    }
+    // 目标对应的源文件
+    fs::path AutoTest::source(ConfigSign name){
+        if(name==Test_Code){
+            return _testfile;
+        }
+        if(name==AC_Code){
+            return _ACfile;
+        }
+        return _basePath/(f(name)+".cpp");
+    }
+    // 检查依赖
+    void AutoTest::check_depend(){
+        _depend.set_path(_baseConfigPath/"depend.json");
+        // 只按源文件判断数据是否失效,编译参数或编译器改变只需要重新编译;旧格式的记录包含编译参数,按不存在处理
+        bool first=!_depend.exist()||!_depend.value().contains("sources");
+        json sources=_depend.value().value("sources",json::object());
+        // 当前各程序的源文件键,源文件不存在时为空
+        std::map<ConfigSign,string> keys;
+        std::map<ConfigSign,bool> changed;
+        for(ConfigSign name:{ Generators,Validators,Checkers,AC_Code,Test_Code }){
+            fs::path src=source(name);
+            keys[name]=fs::exists(src)?to_hex(source_key(name,src)):"";
+            string old=sources.value(f(name),"");
+            // 之前没有记录的程序没有产生过数据
+            changed[name]=!first&&!old.empty()&&old!=keys[name];
+        }
+        if(first){
+            _testlog.tlog("依赖记录不存在,以当前程序为准");
+        }
+        // 生成器或验证器改变: 输入及其之后的全部数据失效
+        bool inputs=changed[Generators]||changed[Validators];
+        // AC代码改变: 标准输出和判题结果失效
+        bool acOutputs=inputs||changed[AC_Code];
+        // 测试代码或检查器改变: 测试输出和判题结果失效
+        bool verdicts=acOutputs||changed[Test_Code]||changed[Checkers];
+        string reused,redo;
+        for(auto &item:changed){
+            (item.second?redo:reused)+=" "+f(item.first);
+        }
+        if(inputs||acOutputs||verdicts){
+            _testlog.tlog("依赖检查: 已改变:"+redo+(reused.empty()?"":"; 未改变:"+reused),loglib::WARNING);
+            invalidate(inputs,acOutputs,verdicts);
+        }
+        else if(!first){
+            _testlog.tlog("依赖检查: 程序均未改变,复用现有数据");
+        }
+        _depend.value()=json::object();
+        for(auto &item:keys){
+            _depend.value()["sources"][f(item.first)]=item.second;
+        }
+        _depend.save();
+    }
+    // 清除数据
+    void AutoTest::invalidate(bool inputs,bool acOutputs,bool verdicts){
+        int count=_config[f(NowData)];
+        // 最小样例要通过验证器,标准输出来自AC代码,这些程序改变后失效,由 minimize 重新生成
+        if(acOutputs&&_WAdatas.value().is_array()){
+            bool stale=false;
+            for(auto &item:_WAdatas.value()){
+                stale|=item.erase("min_in")+item.erase("min_out")>0;
+            }
+            if(stale){
+                _WAdatas.save();
+                _testlog.tlog("错误样例的最小样例已失效,可以用 minimize 重新生成",loglib::WARNING);
+            }
+        }
+        if(inputs){
+            // 种子记录对应被清除的输入
+            wfile(_baseConfigPath/"seed.txt","");
+            // 输入失效时从头生成
+            if(_packed){
+                fs::path corpusPath=_basePath/"corpus";
+                _corpus.close();
+                fs::remove_all(corpusPath);
+                _corpus.open(corpusPath);
+                _workData=0;
+            }
+            else{
+                for(const auto &dir:_dataDirs){
+                    fs::remove_all(dir);
+                    fs::create_directories(dir);
+                }
+            }
+            _testlog.tlog("输入数据已失效,清除"+std::to_string(count)+"个测试点并重新生成",loglib::WARNING);
+            _config[f(NowData)]=0;
+            _config[f(NowTest)]=0;
+            _config["slowest"]=json::array();
+            checkpoint();
+            return;
+        }
+        if(_packed){
+            for(size_t num=1; num<=_corpus.size(); num++){
+                CorpusRecord record=_corpus.record(num);
+                if(!(record.flags&Record_Used)){
+                    continue;
+                }
+                if(acOutputs){
+                    _corpus.drop(num,Slot_AC);
+                }
+                if(verdicts){
+                    _corpus.drop(num,Slot_Out);
+                    record=_corpus.record(num);
+                    record.verdict=-1;
+                    record.time=0;
+                    _corpus.set_record(num,record);
+                }
+            }
+            // 工作区中的输出同样失效
+            _workData=0;
+        }
+        else{
+            if(acOutputs){
+                fs::remove_all(_dataDirs[acData]);
+                fs::create_directories(_dataDirs[acData]);
+            }
+            if(verdicts){
+                fs::remove_all(_dataDirs[outData]);
+                fs::create_directories(_dataDirs[outData]);
+            }
+        }
+        _testlog.tlog("复用"+std::to_string(count)+"个测试点的输入"+
+            (acOutputs?",重新计算标准输出":",复用标准输出")+",重新判题",loglib::WARNING);
+        _config[f(NowTest)]=0;
+        _config["slowest"]=json::array();
+        checkpoint();
+    }
+    // 复用仍然有效的标准输出
+    bool AutoTest::reuse_ac(int num){
+        if(_packed){
+            return _corpus.get_file(num,Slot_AC,data_path(acData,num));
+        }
+        return fs::exists(data_path(acData,num));
+    }
+    // 提交后台编译任务
+    void AutoTest::submit(ConfigSign name,const fs::path &src){
+        if(pending(name)){
+            return;
+        }
+        fs::path target=_baseProgramPath/f(name);
+        // 编译参数在主线程中读取,后台线程不访问配置
+        std::vector<string> flags=profile(name);
+        _jobs[f(name)]=std::async(std::launch::async,[this,src,target,flags](){
+            return compile(src,target,flags);
+            }).share();
+    }
+    // 是否有未取回的编译任务
+    bool AutoTest::pending(ConfigSign name) const{
+        return _jobs.count(f(name))>0;
+    }
+    // 取回编译结果
+    CompileResult AutoTest::ensure(ConfigSign name,const fs::path &src){
+        CompileResult res;
+        auto job=_jobs.find(f(name));
+        if(job!=_jobs.end()){
+            res=job->second.get();
+            _jobs.erase(job);
+        }
+        else{
+            res=compile(src,_baseProgramPath/f(name),profile(name));
+        }
+        // 记录版本键,编译参数或源文件改变时只重新编译受影响的目标
+        if(res.ok){
+            std::ofstream stamp((_baseProgramPath/f(name)).string()+".key",std::ios::trunc);
+            stamp<<to_hex(binary_key(name,src))<<"\n";
+        }
+        // 日志只在主线程输出
+        string info=f(name)+": ";
+        if(res.hit){
+            _testlog.tlog(info+"命中编译缓存 ("+to_hex(res.key)+")");
+        }
+        else if(res.ok){
+            _testlog.tlog(info+"编译完成"+(res.pch?",使用预编译头文件":""));
+        }
+        if(!res.error.empty()){
+            // 编译警告也按目标输出
+            _testlog.tlog(info+"编译器输出:\n"+res.error,res.ok?loglib::WARNING:loglib::ERROR);
+        }
+        return res;
+    }
     // 生成测试工具
     AutoTest &AutoTest::ai_gen(){
         // 添加 testlib 库文件
@@ -1009,6 +1492,13 @@ namespace acm{
         if(!fs::exists(testlib)){
             fs::copy_file(testlibPath,testlib,fs::copy_options::overwrite_existing);
         }
+        // 源文件已经存在的目标提前在后台并行编译,测试代码和AC代码不需要等待工具生成
+        for(ConfigSign name:{ Test_Code,AC_Code,Generators,Validators,Checkers }){
+            fs::path src=source(name);
+            if(fs::exists(src)&&!up_to_date(name,src)){
+                submit(name,src);
+            }
+        }
         // 初始化提示词
         json &session=_history.value();
         // 如果没有数据
@@ -1066,15 +1556,115 @@ namespace acm{
             _testlog.tlog("数据检查器生成失败",loglib::ERROR);
             return *this;
         }
+        // 工具可能被重新生成
+        check_depend();
         return *this;
     }
+    // 当前配置的运行限制
+    AutoTest::Limit AutoTest::limit(){
+        Limit res;
+        // 校准得到的时间倍率,需要用户开启后才改变判题
+        double scale=_config.value().value(f(ApplyTimeScale),false)?_config.value().value(f(TimeScale),1.0):1.0;
+        res.time=std::lround(_config[f(TimeLimit)].get<double>()*scale);
+        res.memory=_config[f(MemLimit)];
+        res.instructions=_config.value().value(f(InstructionBudget),0LL);
+        res.counters=_config.value().value(f(PerfCounters),false)||res.instructions>0;
+        return res;
+    }
+    // 生成器和验证器每次运行的预算
+    AutoTest::Limit AutoTest::tool_limit(){
+        Limit res;
+        res.time=_toolTime;
+        res.memory=_toolMemory;
+        return res;
+    }
+    // 记录一次工具运行
+    void AutoTest::record_tool(ConfigSign name,const Exit &res,size_t bytes,bool rejected){
+        json &stats=_toolStats.value()[f(name)];
+        auto add=[&](const char *key,long long value){
+            json &cell=stats[key];
+            cell=(cell.is_null()?0LL:cell.get<long long>())+value;
+            };
+        auto peak=[&](const char *key,long long value){
+            json &cell=stats[key];
+            cell=std::max(cell.is_null()?0LL:cell.get<long long>(),value);
+            };
+        add("runs",1);
+        add("rejections",rejected);
+        add("timeouts",res.status==process::TIMEOUT);
+        add("memouts",res.status==process::MEMOUT);
+        add("wall_ms",res.wall);
+        add("bytes",bytes);
+        peak("max_wall_ms",res.wall);
+        peak("max_memory_kb",res.memory);
+        // 每秒运行次数和拒绝率
+        long long runs=stats["runs"],wall=stats["wall_ms"];
+        stats["throughput"]=wall>0?runs*1000.0/wall:0.0;
+        stats["rejection_rate"]=stats["rejections"].get<long long>()/(double)runs;
+        _toolStatsDirty=true;
+    }
+    // 工具超出预算时重新生成
+    bool AutoTest::regenerate_tool(ConfigSign name,const string &reason){
+        _testlog.tlog(f(name)+reason,loglib::ERROR);
+        if(!_config.value().value(f(RegenerateTools),false)){
+            return false;
+        }
+        // 每个工具每次运行只重新生成一次,新版本仍然超出预算时停止
+        if(!_regenerated.insert(name).second){
+            _testlog.tlog(f(name)+"已经重新生成过,仍然超出预算",loglib::ERROR);
+            return false;
+        }
+        json stats=_toolStats.value().contains(f(name))?_toolStats.value()[f(name)]:json::object();
+        string hint="上一版本在运行中超出预算: "+reason+"\n运行统计: "+stats.dump()+
+            "\n每次运行的预算为 "+std::to_string(_toolTime)+"ms 和 "+std::to_string(_toolMemory)+
+            "MB,请重新编写,避免死循环和过高的复杂度";
+        if(name==Generators){
+            hint+=",生成的数据必须满足题目约束,不能依赖验证器反复拒绝";
+        }
+        // 旧版本保留为 .slow.cpp
+        fs::path src=source(name);
+        fs::path backup=src;
+        backup.replace_extension(".slow.cpp");
+        fs::rename(src,backup);
+        _testlog.tlog("正在按运行统计重新生成"+f(name),loglib::WARNING);
+        json &session=_history.value();
+        if(!make(name,session,hint)){
+            _testlog.tlog(f(name)+"重新生成失败,恢复旧版本",loglib::ERROR);
+            std::error_code ec;
+            fs::rename(backup,src,ec);
+            return false;
+        }
+        _history.save();
+        // 新版本重新统计
+        _toolStats.value().erase(f(name));
+        _toolStatsDirty=true;
+        check_depend();
+        return true;
+    }
+    // 计时CPU的租约,析构时释放
+    struct CpuLease{
+        Placement *placement=nullptr;
+        int cpu=-1;
+        ~CpuLease(){
+            if(cpu>=0){
+                placement->release(cpu);
+            }
+        }
+    };
     // 运行测试
     AutoTest::Exit AutoTest::run(fs::path program,process::Args args,fs::path infile,fs::path outfile,bool setLimit){
+        return run(program,args,infile,outfile,setLimit?limit():Limit());
+    }
+    // 使用指定限制运行测试
+    AutoTest::Exit AutoTest::run(fs::path program,process::Args args,fs::path infile,fs::path outfile,const Limit &limit,const std::map<string,string> &env){
         // 运行测试
         process::Process proc;
         // 返回值
         Exit res;
         proc.load(program,args);
+        for(const auto &[name,value]:env){
+            proc.set_env(name,value);
+        }
         // _testlog.tlog("正在运行"+program.string());
         // 如果路径不为空，输入文件
         if(!infile.empty()){
@@ -1084,25 +1674,165 @@ namespace acm{
         if(!outfile.empty()){
             proc.set_stdout(outfile);
         }
-        // auto config=_config.get<ns::TestConfig>();
-        if(setLimit){
-            proc.set_memout(_config[f(MemLimit)]);
-            proc.set_timeout(_config[f(TimeLimit)]);
+        if(limit.memory>0){
+            proc.set_memout(limit.memory);
         }
+        // 有指令数预算时按指令数判定超时,墙钟时间只作为兜底
+        bool budget=limit.instructions>0;
+        if(limit.time>0){
+            proc.set_timeout(budget?limit.time*4:limit.time);
+        }
+        // 计时运行独占一个计时CPU,结束或出错时释放
+        CpuLease lease;
+        if(!limit.cpus.empty()){
+            proc.set_affinity(limit.cpus);
+        }
+        else if(_placed&&timed(program)){
+            lease.placement=&_placement;
+            lease.cpu=_placement.acquire();
+            if(lease.cpu>=0){
+                proc.set_affinity({ lease.cpu });
+            }
+        }
+        res.cpu=lease.cpu;
+        proc.set_counters(limit.counters);
         proc.start();
         // 等待运行结束
         res.status=proc.wait();
         res.exit_code=proc.get_exit_code();
-        res.error=proc.get_error();
-        // 去除回车
-        if(*res.error.rbegin()=='\n'){
-            res.error.pop_back();
+        res.time=proc.get_time();
+        res.timeUs=proc.get_time_us();
+        res.wall=proc.get_wall_time();
+        res.memory=proc.get_memory();
+        res.counters=proc.get_counters();
+        if(budget&&res.status!=process::TIMEOUT){
+            if(res.counters.instructions>=0){
+                if(res.counters.instructions>limit.instructions){
+                    res.status=process::TIMEOUT;
+                }
+            }
+            else{
+                // 指令计数不可用时退回到墙钟时间
+                res.wallBudget=true;
+                if(limit.time>0&&res.wall>limit.time){
+                    res.status=process::TIMEOUT;
+                }
+            }
         }
+        res.report=proc.get_report();
+        // 错误信息与 get_error 一致,各行直接拼接
+        res.error=res.report;
+        res.error.erase(std::remove(res.error.begin(),res.error.end(),'\n'),res.error.end());
         if(outfile.empty()){
             res.content=proc.read();
         }
         return res;
     }
+    // 性能计数器,不可用的计数为 null
+    static json counters_json(const process::CounterValues &values){
+        auto value=[](long long v){
+            return v>=0?json(v):json();
+        };
+        return {
+            { "instructions",value(values.instructions) },
+            { "cycles",value(values.cycles) },
+            { "cache_misses",value(values.cacheMisses) },
+            { "branch_misses",value(values.branchMisses) },
+            { "page_faults",value(values.pageFaults) }
+        };
+    }
+    // 接近时间限制或超时的运行重复计时
+    AutoTest::Exit AutoTest::retime(const fs::path &program,const process::Args &args,const fs::path &in,const fs::path &out,const Limit &limit,const Exit &first,const string &name){
+        if(_retimeCount<=0||limit.time<=0||out.empty()){
+            return first;
+        }
+        // 按指令数判定时结果与机器负载无关,不需要重复计时
+        if(limit.instructions>0&&first.counters.instructions>=0){
+            return first;
+        }
+        // 运行错误和超内存与计时无关,不重复计时
+        if(first.status!=process::STOP&&first.status!=process::TIMEOUT){
+            return first;
+        }
+        if(first.status==process::STOP&&first.wall<limit.time*(1-_retimeMargin)){
+            return first;
+        }
+        Limit pinned=limit;
+        // 放宽限制以得到超时运行的实际用时
+        pinned.time=limit.time*2;
+        // 重复计时期间独占一个计时CPU,不同的重复计时在不同的计时CPU上同时进行
+        CpuLease lease;
+        if(pinned.cpus.empty()){
+            lease.placement=&_placement;
+            lease.cpu=_placement.acquire();
+            if(lease.cpu>=0){
+                pinned.cpus={ lease.cpu };
+            }
+        }
+        fs::path temp=out.string()+".retime";
+        std::vector<double> walls,times;
+        Exit result=first;
+        // 第一次运行正常结束时保留它的输出和结果,重复运行只用于计时
+        bool finished=first.status==process::STOP;
+        for(int i=0; i<_retimeCount; i++){
+            Exit res=run(program,args,in,temp,pinned);
+            walls.push_back(res.status==process::TIMEOUT?pinned.time:res.wall);
+            times.push_back(res.time);
+            // 第一次超时时保留重复运行中第一次正常结束的输出
+            if(res.status==process::STOP&&!finished){
+                finished=true;
+                result=res;
+                std::error_code ec;
+                fs::copy_file(temp,out,fs::copy_options::overwrite_existing,ec);
+            }
+        }
+        std::error_code ec;
+        fs::remove(temp,ec);
+        double middle=median(walls);
+        double spread=(*std::max_element(walls.begin(),walls.end())-*std::min_element(walls.begin(),walls.end()))/std::max(1.0,middle);
+        bool noisy=spread>_retimeNoise;
+        // 按中位数判定是否超时
+        if(middle>limit.time||!finished){
+            result.status=process::TIMEOUT;
+        }
+        result.wall=middle;
+        result.time=median(times);
+        // 工作线程不写日志,记录随结果返回
+        result.retimed={
+            { "name",name },
+            { "limit",limit.time },
+            { "first",first.status==process::TIMEOUT?-1:first.wall },
+            { "samples",walls },
+            { "median",middle },
+            { "spread",spread },
+            { "timeout",result.status==process::TIMEOUT },
+            { "noisy",noisy },
+            { "cpu",result.cpu },
+            { "counters",counters_json(result.counters) }
+        };
+        return result;
+    }
+    // 写入重复计时的记录
+    void AutoTest::report_retime(const json &line){
+        if(line.is_null()){
+            return;
+        }
+        append_to(_baseConfigPath/"stats.jsonl",line.dump()+"\n");
+        bool noisy=line["noisy"];
+        char text[256];
+        snprintf(text,sizeof(text),"%s: 用时接近时间限制,重复计时%d次, 中位数%.0fms, 波动%.0f%%, %s%s",line["name"].get<string>().c_str(),
+            (int)line["samples"].size(),line["median"].get<double>(),line["spread"].get<double>()*100,
+            line["timeout"].get<bool>()?"判定超时":"判定未超时",noisy?", 计时不稳定":"");
+        _testlog.tlog(text,noisy?loglib::WARNING:loglib::INFO);
+    }
+    // 提示指令数预算退回到墙钟时间
+    void AutoTest::report_budget(bool wallBudget){
+        if(!wallBudget||_budgetWarned){
+            return;
+        }
+        _budgetWarned=true;
+        _testlog.tlog("指令计数不可用,指令数预算退回到按墙钟时间判定",loglib::WARNING);
+    }
     // 保存到文件
     void AutoTest::append_to(const fs::path &filePath,const string &content){
         // 追加到文件
@@ -1115,130 +1845,599 @@ namespace acm{
         file.close();
     }
     // 生成指定权重数字
-    int AutoTest::random_weight(int val0,int val1,int val2){
-        // 生成指定权重数字 按照val012的大小按权分配，生成加权概率的0，1，2三个数字
-        static std::mt19937 gen(static_cast<unsigned>(std::time(nullptr)));
-
-        // 计算总权重
-        int totalWeight=val0+val1+val2;
-        // 权重数组
-        std::vector<int> weights={ val0,val1,val2 };
-        // 生成1到总权重之间的随机数
-        std::uniform_int_distribution<> dist(1,totalWeight);
-        int randomNum=dist(gen);
-
-        // 根据权重选择数字
-        int cumulativeWeight=0;
-        for(size_t i=0; i<weights.size(); ++i){
-            cumulativeWeight+=weights[i];
-            if(randomNum<=cumulativeWeight){
-                return i;
-            }
-        }
-
-        return 0; // 防止意外情况
+    int AutoTest::random_weight(int val0,int val1,int val2,uint64_t key){
+        // 按照val012的大小按权分配，生成加权概率的0，1，2三个数字
+        CounterRng rng(key);
+        return weighted_index({ val0,val1,val2 },rng.next());
     }
     // 生成随机字符串
-    string AutoTest::random_string(int length){
-        // 生成随机字符串
+    string AutoTest::random_string(int length,uint64_t key){
         static const char alphanum[]="0123456789abcdefghijklmnopqrstuvwxyz";
-        static std::mt19937 gen(std::chrono::system_clock::now().time_since_epoch().count());
-        std::uniform_int_distribution<> dist(0,sizeof(alphanum)-2); // -2 because of null terminator
-
+        CounterRng rng(key);
         string result;
         result.reserve(length);
         for(int i=0; i<length; i++){
-            result+=alphanum[dist(gen)];
+            result+=alphanum[rng.below(sizeof(alphanum)-1)];
         }
         return result;
     }
-    // 生成数据
-    bool AutoTest::generate_data(int testnum){
-        // 检测是否已经编译和生成
-        if(!(fs::exists(_baseProgramPath/f(Generators))&&
-            fs::exists(_baseProgramPath/f(Validators))&&
-            fs::exists(_baseProgramPath/f(Checkers)))){
-            _testlog.tlog("测试文件不存在,请先编译",loglib::ERROR);
+    // 测试点的生成器模式
+    int AutoTest::select_mode(int num){
+        // 是否启用权重输出
+        if(_config[f(Test_Weight)]){
+            return random_weight(_config[f(Weights)][0],
+                _config[f(Weights)][1],
+                _config[f(Weights)][2],
+                derive(_master,num,Stream_Mode));
+        }
+        // 前 special 个测试点为特例,随后 edge 个为边界
+        int Special_nums=_config[f(Special)];
+        int Edge_nums=_config[f(Edge)];
+        if(num<=Special_nums){
+            return 1;
+        }
+        if(num<=Special_nums+Edge_nums){
+            return 2;
+        }
+        return 0;
+    }
+    // 调度器的臂,生成器只在模式1读取规模千分比,其他模式的规模为0不传给生成器
+    static const struct{
+        int mode;
+        int scale;
+    } SchedulerArms[]={ { 0,0 },{ 1,1000 },{ 1,100 },{ 1,10 },{ 2,0 } };
+    // 初始化自适应调度器
+    bool AutoTest::init_scheduler(){
+        string scheduler=_config.value().value(f(Scheduler),string(""));
+        if(scheduler.empty()){
+            _bandit.reset();
+            return true;
+        }
+        try{
+            _bandit=std::make_unique<Bandit>(Bandit::parse(scheduler));
+        }
+        catch(const std::exception &e){
+            _testlog.tlog(string(e.what())+",可选 thompson 或 ucb",loglib::ERROR);
             return false;
         }
-
-        // 循环生成并校验数据直到数据符合题目要求
-        while(testnum--){
-            // auto config=_config.get<ns::TestConfig>();
-            int num=_config[f(NowData)];
-            // int num=config.now_data+1;
-            num++;
-            string info="第"+std::to_string(num)+"个测试点";
-            _testlog.tlog("生成"+info);
-            // 读取计数
-            string dataName="data"+std::to_string(num);
-            _config[f(DataNum)]=dataName;
-            // 设置路径
-            process::Args args;
-            // 特判生成数量
-            int Special_nums=_config[f(Special)];
-            // 边界生成数量
-            int Edge_nums=_config[f(Edge)];
-            // 生成随机哈希
-            string hash=random_string(8);
-            _randomSeed=dataName+" : "+hash+"\n";
-            // 是否启用权重输出
-            if(_config[f(Test_Weight)]){
-                // 生成权重
-                int weight=random_weight(_config[f(Weights)][0],
-                    _config[f(Weights)][1],
-                    _config[f(Weights)][2]);
-                args.add(f(Generators)).add(weight).add(hash);
-            }
-            else{
-                if(Special_nums>0){
-                    args.add(f(Generators)).add(1).add(hash);
-                    Special_nums--;
-                }
-                else if(Edge_nums>0){
-                    args.add(f(Generators)).add(2).add(hash);
-                    Edge_nums--;
-                }
-                else{
-                    args.add(f(Generators)).add(0).add(hash);
-                }
+        for(const auto &item:SchedulerArms){
+            _bandit->add_arm("mode"+std::to_string(item.mode)+(item.scale>0?"_scale"+std::to_string(item.scale):""));
+        }
+        // 统计按题目保存,重启后继续学习
+        _banditState.set_path(_baseConfigPath/"bandit.json");
+        _bandit->load(_banditState.value().value("arms",json::object()));
+        return true;
+    }
+    // 记录调度生成的测试点的判题结果
+    void AutoTest::schedule(int num,JudgeCode verdict,int time){
+        auto pos=_pulls.find(num);
+        if(!_bandit||pos==_pulls.end()){
+            return;
+        }
+        _bandit->observe(pos->second.arm,verdict==Accept?Bandit::Outcome_Pass:Bandit::Outcome_Failure,pos->second.cost+time);
+        _pulls.erase(pos);
+        _banditState.value()["arms"]=_bandit->state();
+        _banditDirty=true;
+    }
+    // 初始化CPU分配
+    bool AutoTest::init_placement(){
+        _placed=_config.value().value(f(CorePlacement),false);
+        // 第一次分配前允许的CPU,之后主进程只在辅助CPU上运行
+        static const std::vector<int> allowed=process::Process::allowed_cpus();
+        if(!_placed){
+            // 未启用时只用自动划分的计时CPU给重复计时提供租约,主进程和其他运行不绑定
+            _placement.configure(Placement::topology(allowed));
+            return true;
+        }
+        json map=_config.value().value(f(CoreMap),json::object());
+        // CPU列表可以是数组或 "0-3,8" 格式的字符串
+        auto cpus=[&](const char *key){
+            if(!map.is_object()||!map.contains(key)){
+                return std::vector<int>();
             }
-            // 生成数据并检查数据是否符合要求
-            // 同步设置
-            // _config.sync<ns::TestConfig>();
-            Exit res=run(_baseProgramPath/f(Generators),
-                args,"",
-                _dataDirs[inData]/(dataName+".in"),
-                false);
-            if(res.status==process::STOP){
-                _testlog.tlog(info+": 数据生成器运行成功");
+            return map[key].is_string()?Placement::parse_list(map[key]):map[key].get<std::vector<int>>();
+        };
+        try{
+            _placement.configure(Placement::topology(allowed),cpus("solution"),cpus("helper"));
+        }
+        catch(const std::exception &e){
+            _testlog.tlog(string("CPU分配错误: ")+e.what(),loglib::ERROR);
+            return false;
+        }
+        _placement.bind_helper();
+        _testlog.tlog("CPU分配: "+_placement.report());
+        if(_placement.shared()){
+            _testlog.tlog("计时CPU与其他CPU共用物理核心,计时可能受到影响",loglib::WARNING);
+        }
+        return true;
+    }
+    // 在所有核心上并行执行 n 个任务,任务中不能访问配置或写日志
+    static void parallel_for(size_t n,const std::function<void(size_t)> &task){
+        std::atomic<size_t> next{ 0 };
+        auto worker=[&](){
+            for(size_t i=next++; i<n; i=next++){
+                task(i);
             }
-            else{
-                _testlog.tlog(info+": 数据生成器运行失败,错误信息："+res.error,loglib::ERROR);
+            };
+        size_t count=std::min<size_t>(n,std::max(1u,std::thread::hardware_concurrency()));
+        std::vector<std::thread> threads;
+        for(size_t i=1; i<count; i++){
+            threads.emplace_back(worker);
+        }
+        // 当前线程同样参与
+        worker();
+        for(auto &thread:threads){
+            thread.join();
+        }
+    }
+    // 读取参考解配置
+    bool AutoTest::init_references(){
+        _references.clear();
+        std::set<string> names={ f(Test_Code),f(AC_Code) };
+        for(const auto &item:_config.value().value(f(References),json::array())){
+            Reference ref;
+            ref.name=item.value("name",string(""));
+            ref.file=item.value("file",string(""));
+            if(ref.name.empty()||ref.file.empty()||ref.name.find('/')!=string::npos){
+                _testlog.tlog("参考解配置错误: 需要 name 和 file, name 不能包含 /",loglib::ERROR);
                 return false;
             }
-            // 运行数据验证器
-            args.clear();
-            args.add(f(Validators));
-            res=run(_baseProgramPath/f(Validators),args,_dataDirs[inData]/(dataName+".in"),"",false);
-            if(res.status==process::STOP){
-                _testlog.tlog(info+": 数据验证成功");
-                _config[f(NowData)]=num;
-                _config[f(Special)]=Special_nums;
-                _config[f(Edge)]=Edge_nums;
-                _config.save();
-                append_to(_baseConfigPath/"seed.txt",_randomSeed);
+            if(!names.insert(ref.name).second){
+                _testlog.tlog("参考解名称重复: "+ref.name,loglib::ERROR);
+                return false;
             }
-            else if(res.status==process::ERROR){
-                _testlog.tlog(info+": 数据生成不符合要求，正在重新生成。"+
-                    "不符合信息："+res.error,
-                    loglib::WARNING);
-                // 重新生成本次数据
-                testnum++;
-                continue;
+            // 相对路径相对于题目文件夹
+            if(ref.file.is_relative()){
+                ref.file=_basePath/ref.file;
             }
-            else{
-                _testlog.tlog(info+": 数据验证器运行失败。"+
+            ref.maxInputBytes=item.value("max_input_bytes",(size_t)0);
+            ref.timeLimit=item.value("time_limit",0);
+            _references.push_back(ref);
+        }
+        _referenceState.set_path(_baseConfigPath/"references.json");
+        return true;
+    }
+    // 编译参考解
+    bool AutoTest::compile_references(){
+        for(const auto &ref:_references){
+            CompileResult res=compile(ref.file,_baseProgramPath/("ref_"+ref.name),profile(AC_Code));
+            if(!res.ok){
+                _testlog.tlog("参考解 "+ref.name+" 编译失败\n编译错误信息: "+res.error,loglib::ERROR);
+                return false;
+            }
+        }
+        return true;
+    }
+    // 在测试点上并行运行参考解
+    json AutoTest::cross_check(int num){
+        json verdicts=json::object();
+        if(_references.empty()){
+            return verdicts;
+        }
+        fs::path dir=_basePath/"work"/"references";
+        fs::create_directories(dir);
+        fs::path in=data_path(inData,num),ans=data_path(acData,num);
+        size_t bytes=fs::file_size(in);
+        Limit base=limit();
+        base.counters=false;
+        base.instructions=0;
+        // 没有运行的参考解保持 Waiting
+        std::vector<JudgeCode> results(_references.size(),Waiting);
+        std::vector<char> ran(_references.size(),0);
+        parallel_for(_references.size(),[&](size_t i){
+            const Reference &ref=_references[i];
+            // 暴力解只在小输入上运行,不拖慢对拍
+            if(ref.maxInputBytes>0&&bytes>ref.maxInputBytes){
+                return;
+            }
+            Limit lim=base;
+            if(ref.timeLimit>0){
+                lim.time=ref.timeLimit;
+            }
+            string name="ref_"+ref.name;
+            fs::path out=dir/(name+".out");
+            process::Args args;
+            args.add(name);
+            Exit res=run(_baseProgramPath/name,args,in,out,lim);
+            JudgeCode verdict=judge(res.status,res.exit_code);
+            if(verdict==Waiting){
+                verdict=check_case(in,out,ans,res);
+            }
+            results[i]=verdict;
+            ran[i]=1;
+            std::error_code ec;
+            fs::remove(out,ec);
+            });
+        for(size_t i=0; i<_references.size(); i++){
+            if(ran[i]){
+                verdicts[_references[i].name]=f(results[i]);
+            }
+        }
+        return verdicts;
+    }
+    // 记录判题矩阵的一行
+    void AutoTest::report_references(int num,const json &verdicts,JudgeCode verdict){
+        if(_references.empty()){
+            return;
+        }
+        json &state=_referenceState.value();
+        // 每个程序每种判题结果的次数,测试代码的结果同样以AC代码为准
+        auto count=[&](const string &name,const string &result){
+            json &cell=state["matrix"][name][result];
+            cell=cell.is_null()?1:cell.get<int>()+1;
+            };
+        count(f(Test_Code),f(verdict));
+        // 只有输出与AC代码不同才是不一致,超时和运行错误等只说明参考解没有跑完
+        json disagree=json::object(),failed=json::object();
+        for(const auto &[name,result]:verdicts.items()){
+            string code=result.get<string>();
+            count(name,code);
+            if(code==f(WrongAnswer)||code==f(PresentationError)){
+                disagree[name]=code;
+            }
+            else if(code!=f(Accept)){
+                failed[name]=code;
+            }
+        }
+        if(!failed.empty()){
+            _testlog.tlog("第"+std::to_string(num)+"个测试点: 参考解运行失败 "+failed.dump(),loglib::WARNING);
+        }
+        // 参考解与AC代码不一致时至少有一方是错的,保存输入供人工检查
+        if(!disagree.empty()){
+            string dataName="data"+std::to_string(num);
+            _testlog.tlog("第"+std::to_string(num)+"个测试点: 参考解与AC代码不一致 "+disagree.dump(),loglib::WARNING);
+            json &list=state["disagreements"];
+            if(list.size()<100){
+                list.push_back({
+                    { "name",dataName },
+                    { "in",read_data(inData,num) },
+                    { "out",read_data(acData,num) },
+                    { f(Test_Code),f(verdict) },
+                    { "references",verdicts }
+                    });
+            }
+        }
+        _referenceDirty=true;
+    }
+    // 是否为需要独占计时CPU的程序
+    bool AutoTest::timed(const fs::path &program){
+        string name=program.filename().string();
+        return name==f(Test_Code)||name==f(AC_Code)||name==f(Test_Code)+"_cov"||name=="benchmark";
+    }
+    // 测试点是否属于当前分片
+    bool AutoTest::in_shard(int num){
+        return (num-1)%_shardCount==_shardIndex;
+    }
+    // 测试点数据路径
+    fs::path AutoTest::data_path(DataFloder floder,int num){
+        if(_packed){
+            // 打包存储时所有测试点共用工作区中的三个文件
+            static const char *names[]={ "data.in","data.out","ac.out" };
+            return _workPath/names[floder];
+        }
+        return _dataDirs[floder]/("data"+std::to_string(num)+(floder==inData?".in":".out"));
+    }
+    // 测试点是否存在
+    bool AutoTest::has_data(int num){
+        if(_packed){
+            // seed 策略下通过的测试点只有记录没有数据
+            return _corpus.record(num).flags&Record_Used;
+        }
+        return fs::exists(data_path(inData,num));
+    }
+    // 读取测试点数据
+    string AutoTest::read_data(DataFloder floder,int num){
+        if(_packed){
+            CorpusSlot slot=static_cast<CorpusSlot>(floder);
+            if(_corpus.has(num,slot)){
+                return string(_corpus.get(num,slot));
+            }
+            // 未保存的数据只可能在工作区中
+            if(floder==inData&&!load_data(num)){
+                return "";
+            }
+            if(num!=_workData){
+                return "";
+            }
+        }
+        return rfile(data_path(floder,num));
+    }
+    // 生成器可执行文件哈希
+    uint64_t AutoTest::generator_hash(){
+        fs::path file=_baseProgramPath/f(Generators);
+        std::error_code ec;
+        fs::file_time_type time=fs::last_write_time(file,ec);
+        if(ec){
+            return 0;
+        }
+        // 生成器没有重新编译时沿用缓存
+        if(_genHash==0||time!=_genTime){
+            _genHash=hash_file(file);
+            _genTime=time;
+        }
+        return _genHash;
+    }
+    // 按种子重新生成测试点输入
+    bool AutoTest::materialize(int num,const fs::path &file){
+        CorpusRecord record=_corpus.record(num);
+        string seed(record.seed,strnlen(record.seed,sizeof(record.seed)));
+        string info="第"+std::to_string(num)+"个测试点";
+        if(record.flags&Record_Mutant){
+            _testlog.tlog(info+": 变异数据没有种子,无法重新生成",loglib::ERROR);
+            return false;
+        }
+        if(record.mode<0||seed.empty()){
+            _testlog.tlog(info+": 没有数据也没有种子,无法重新生成",loglib::ERROR);
+            return false;
+        }
+        if(record.genHash!=0&&record.genHash!=generator_hash()){
+            _testlog.tlog(info+": 生成器已经改变,重新生成的数据可能与原数据不同",loglib::WARNING);
+        }
+        process::Args args;
+        args.add(f(Generators)).add(record.mode).add(seed);
+        if(record.scale>0){
+            args.add(record.scale).add(0);
+        }
+        Exit res=run(_baseProgramPath/f(Generators),args,"",file,tool_limit());
+        if(res.status!=process::STOP){
+            _testlog.tlog(info+": 按种子重新生成失败,错误信息: "+res.error,loglib::ERROR);
+            return false;
+        }
+        return true;
+    }
+    // 准备测试点输入到工作区
+    bool AutoTest::load_data(int num){
+        if(!_packed||_workData==num){
+            return true;
+        }
+        if(!_corpus.get_file(num,Slot_In,data_path(inData,num))){
+            if(!materialize(num,data_path(inData,num))){
+                return false;
+            }
+        }
+        _workData=num;
+        return true;
+    }
+    // 保存工作区中的测试点数据
+    void AutoTest::store_data(DataFloder floder,int num,bool force){
+        // seed 策略下由 retain 决定是否保存
+        if(!_packed||(_seedOnly&&!force)){
+            return;
+        }
+        _corpus.put_file(num,static_cast<CorpusSlot>(floder),data_path(floder,num));
+        if(floder==inData){
+            _workData=num;
+        }
+    }
+    // 记录判题结果并按保留策略决定是否保存数据
+    void AutoTest::retain(int num,JudgeCode verdict,int time){
+        if(!_packed){
+            return;
+        }
+        CorpusRecord record=_corpus.record(num);
+        record.verdict=verdict;
+        record.time=time;
+        _corpus.set_record(num,record);
+        if(!_seedOnly){
+            return;
+        }
+        // 变异数据无法按种子重新生成,总是保留
+        bool keep=verdict!=Accept||(record.flags&Record_Mutant);
+        if(!keep){
+            // 通过的测试点只保留最慢的若干个
+            json slowest=_config["slowest"].is_array()?_config["slowest"]:json::array();
+            size_t limit=_config[f(KeepSlowest)].get<size_t>();
+            auto pos=slowest.begin();
+            while(pos!=slowest.end()&&(*pos)[1].get<int>()>=time){
+                pos++;
+            }
+            if(pos!=slowest.end()||slowest.size()<limit){
+                slowest.insert(pos,json::array({ num,time }));
+                keep=true;
+            }
+            while(slowest.size()>limit){
+                // 被挤出的测试点只保留种子
+                int evict=slowest.back()[0];
+                slowest.erase(slowest.end()-1);
+                if(evict==num){
+                    keep=false;
+                    continue;
+                }
+                for(int slot=Slot_In; slot<Slot_Num; slot++){
+                    _corpus.drop(evict,static_cast<CorpusSlot>(slot));
+                }
+            }
+            if(keep){
+                progress({ { "slowest",slowest } });
+            }
+        }
+        if(keep){
+            store_data(inData,num,true);
+            store_data(outData,num,true);
+            store_data(acData,num,true);
+        }
+    }
+    // 导出打包数据为松散文件
+    bool AutoTest::export_data(const fs::path &path){
+        if(!_packed){
+            _testlog.tlog("当前文件夹使用松散文件存储,无需导出",loglib::WARNING);
+            return false;
+        }
+        std::vector<fs::path> dirs={
+            path/"inData",
+            path/"outData",
+            path/"acData"
+        };
+        size_t count=_corpus.export_to(dirs);
+        // 只有种子的测试点按需重新生成输入和标准输出
+        size_t regen=0;
+        for(size_t num=1; num<=_corpus.size(); num++){
+            if(!(_corpus.record(num).flags&Record_Used)||_corpus.has(num,Slot_In)){
+                continue;
+            }
+            string name="data"+std::to_string(num);
+            if(!materialize(num,dirs[inData]/(name+".in"))){
+                continue;
+            }
+            if(fs::exists(_baseProgramPath/f(AC_Code))){
+                process::Args args;
+                args.add(f(AC_Code));
+                run(_baseProgramPath/f(AC_Code),args,dirs[inData]/(name+".in"),dirs[acData]/(name+".out"));
+            }
+            regen++;
+        }
+        _testlog.tlog("已导出"+std::to_string(count+regen)+"个测试点到: "+path.string()+
+            (regen>0?",其中"+std::to_string(regen)+"个按种子重新生成":""));
+        return true;
+    }
+    // 生成数据
+    bool AutoTest::generate_data(int testnum){
+        // 检测是否已经编译和生成
+        if(!(fs::exists(_baseProgramPath/f(Generators))&&
+            fs::exists(_baseProgramPath/f(Validators))&&
+            fs::exists(_baseProgramPath/f(Checkers)))){
+            _testlog.tlog("测试文件不存在,请先编译",loglib::ERROR);
+            return false;
+        }
+
+        // 循环生成并校验数据直到数据符合题目要求
+        while(testnum--){
+            // auto config=_config.get<ns::TestConfig>();
+            int num=_config[f(NowData)];
+            // int num=config.now_data+1;
+            num++;
+            // 跳过其他分片的测试点
+            while(!in_shard(num)){
+                num++;
+            }
+            // 同一测试点校验失败后重试的次数
+            if(num!=_attemptData){
+                _attemptData=num;
+                _attempt=0;
+            }
+            string info="第"+std::to_string(num)+"个测试点";
+            _testlog.tlog("生成"+info);
+            // 读取计数
+            string dataName="data"+std::to_string(num);
+            _config[f(DataNum)]=dataName;
+            // 设置路径
+            process::Args args;
+            // 由主种子和测试点编号派生随机哈希,重试时使用新的随机流
+            string hash=random_string(8,derive(_master,num,Stream_Seed+((uint64_t)_attempt<<8)));
+            _randomSeed=dataName+" : "+hash+"\n";
+            // 生成器模式
+            int mode=select_mode(num);
+            args.add(f(Generators)).add(mode).add(hash);
+            // 启用调度器时由调度器选择模式和规模
+            size_t arm=0;
+            int scale=0;
+            if(_bandit){
+                arm=_bandit->select(derive(_master,num,Stream_Bandit+((uint64_t)_attempt<<8)));
+                mode=SchedulerArms[arm].mode;
+                scale=SchedulerArms[arm].scale;
+                args.clear();
+                args.add(f(Generators)).add(mode).add(hash);
+                _randomSeed=dataName+" : "+hash+" "+std::to_string(mode)+"\n";
+                if(scale>0){
+                    args.add(scale).add(0);
+                    _randomSeed=dataName+" : "+hash+" "+std::to_string(mode)+" "+std::to_string(scale)+"\n";
+                }
+                _testlog.tlog(info+": 调度器选择 "+_bandit->arm(arm).name);
+            }
+            // 生成数据并检查数据是否符合要求
+            // 同步设置
+            // _config.sync<ns::TestConfig>();
+            Exit res=run(_baseProgramPath/f(Generators),
+                args,"",
+                data_path(inData,num),
+                tool_limit());
+            std::error_code ec;
+            auto budget=[&](const Exit &exit){
+                return exit.status==process::TIMEOUT?"超出时间预算 "+std::to_string(_toolTime)+"ms":"超出内存预算 "+std::to_string(_toolMemory)+"MB";
+                };
+            record_tool(Generators,res,res.status==process::STOP?fs::file_size(data_path(inData,num),ec):0,false);
+            if(res.status==process::STOP){
+                _testlog.tlog(info+": 数据生成器运行成功");
+            }
+            else if(res.status==process::TIMEOUT||res.status==process::MEMOUT){
+                // 超出预算时立即停止,按配置重新生成后重试本测试点
+                if(!regenerate_tool(Generators,": "+info+budget(res))){
+                    return false;
+                }
+                testnum++;
+                continue;
+            }
+            else{
+                _testlog.tlog(info+": 数据生成器运行失败,错误信息："+res.error,loglib::ERROR);
+                return false;
+            }
+            double cost=res.time;
+            // 运行数据验证器
+            args.clear();
+            args.add(f(Validators));
+            res=run(_baseProgramPath/f(Validators),args,data_path(inData,num),"",tool_limit());
+            record_tool(Validators,res,0,res.status==process::ERROR);
+            cost+=res.time;
+            if(res.status==process::TIMEOUT||res.status==process::MEMOUT){
+                if(!regenerate_tool(Validators,": "+info+budget(res))){
+                    return false;
+                }
+                testnum++;
+                continue;
+            }
+            if(res.status==process::STOP){
+                _rejections=0;
+                _testlog.tlog(info+": 数据验证成功");
+                if(_bandit){
+                    // 重复的数据不再测试,多次重复后不再重试
+                    if(!_inputHashes.insert(hash_file(data_path(inData,num))).second&&_attempt<100){
+                        _bandit->observe(arm,Bandit::Outcome_Duplicate,cost);
+                        _testlog.tlog(info+": 数据与之前的测试点重复,正在重新生成",loglib::WARNING);
+                        _attempt++;
+                        testnum++;
+                        continue;
+                    }
+                    _pulls[num]={ arm,cost };
+                }
+                store_data(inData,num);
+                if(_packed){
+                    CorpusRecord record=_corpus.record(num);
+                    hash.copy(record.seed,sizeof(record.seed)-1);
+                    record.mode=mode;
+                    record.verdict=-1;
+                    record.genHash=generator_hash();
+                    record.scale=scale;
+                    _corpus.set_record(num,record);
+                    _workData=num;
+                }
+                progress({
+                    { f(NowData),num },
+                    { f(DataNum),dataName }
+                    });
+                append_to(_baseConfigPath/"seed.txt",_randomSeed);
+            }
+            else if(res.status==process::ERROR){
+                _testlog.tlog(info+": 数据生成不符合要求，正在重新生成。"+
+                    "不符合信息："+res.error,
+                    loglib::WARNING);
+                if(_bandit){
+                    _bandit->observe(arm,Bandit::Outcome_Rejected,cost);
+                }
+                // 连续被拒绝过多时生成器很可能不满足约束,不再无限重试
+                int maxRejections=_config.value().value(f(MaxRejections),50);
+                if(++_rejections>=maxRejections){
+                    _rejections=0;
+                    if(!regenerate_tool(Generators,": "+info+"连续 "+std::to_string(maxRejections)+" 次被验证器拒绝")){
+                        return false;
+                    }
+                }
+                // 重新生成本次数据
+                _attempt++;
+                testnum++;
+                continue;
+            }
+            else{
+                _testlog.tlog(info+": 数据验证器运行失败。"+
                     "错误信息："+res.error+
                     "失败信息:"+res.content,
                     loglib::ERROR);
@@ -1251,32 +2450,31 @@ namespace acm{
     bool AutoTest::test_data(){
         process::Args args;
         // 检测测试代码和AC代码是否编译
-        if(!fs::exists(_baseProgramPath/f(Test_Code))){
-            args.clear();
+        if(!up_to_date(Test_Code,_testfile)||pending(Test_Code)){
             // 编译test代码
-            args.add("g++").add(_testfile).add("-o").add(_baseProgramPath/f(Test_Code));
             _testlog.tlog("正在编译测试代码");
-            Exit res=run("/bin/g++",args,"","",false);
+            CompileResult res=ensure(Test_Code,_testfile);
             // 如果不是正常退出输出错误信息
-            if(res.status!=process::STOP){
+            if(!res.ok){
                 _testlog.tlog("测试代码编译失败\n编译错误信息: "+res.error
                     ,loglib::ERROR);
                 return false;
             }
         }
-        if(!fs::exists(_baseProgramPath/f(AC_Code))){
-            args.clear();
+        if(!up_to_date(AC_Code,_ACfile)||pending(AC_Code)){
             // 编译AC代码
-            args.add("g++").add(_ACfile).add("-o").add(_baseProgramPath/f(AC_Code));
             _testlog.tlog("正在编译AC代码");
-            Exit res=run("/bin/g++",args,"","",false);
+            CompileResult res=ensure(AC_Code,_ACfile);
             // 如果不是正常退出输出错误信息
-            if(res.status!=process::STOP){
+            if(!res.ok){
                 _testlog.tlog("AC代码编译失败\n编译错误信息: "+res.error
                     ,loglib::ERROR);
                 return false;
             }
         }
+        if(!compile_references()){
+            return false;
+        }
         // 检测测试数据是否已经生成
         if(_config.value().find(f(DataNum))==_config.value().end()){
             _testlog.tlog("测试数据不存在,请先生成数据",loglib::ERROR);
@@ -1287,8 +2485,7 @@ namespace acm{
         int num=_config[f(NowTest)];
         // 检测第num个测试点文件是否存在
         while(true){
-            string fileName="data"+std::to_string(num)+".in";
-            if(!fs::exists(_dataDirs[inData]/fileName)){
+            if(!has_data(num)){
                 num++;
             }
             else{
@@ -1296,6 +2493,7 @@ namespace acm{
             }
             if(num>target_num){
                 _testlog.tlog("没有可以测试的测试点",loglib::WARNING);
+                break;
             }
         }
         // int target_num=config.now_data;
@@ -1303,6 +2501,8 @@ namespace acm{
         // 循环验证数据直到找到不一致的数据
         do{
             if(num>target_num) break;
+            // 跳过其他分片或不存在的测试点
+            if(!has_data(num)) continue;
             args.clear();
             string info="第"+std::to_string(num)+"个测试点";
             _testlog.tlog("测试"+info);
@@ -1310,56 +2510,90 @@ namespace acm{
             string dataName="data"+std::to_string(num);
             _config[f(DataNum)]=dataName;
             // config.data_num=dataName;
+            // 准备输入数据
+            if(!load_data(num)){
+                return false;
+            }
             // 运行对应的Test代码
             args.add(f(Test_Code));
             Exit res=run(_baseProgramPath/f(Test_Code),
                 args,
-                _dataDirs[inData]/(dataName+".in"),
-                _dataDirs[outData]/(dataName+".out"));
-            JudgeCode temp;
-            if(res.status==process::STOP){
-                temp=judge(res.status,res.exit_code);
-                _testlog.tlog(info+": 测试代码已运行");
-                _config[f(JudgeStatus)]=f(temp);
-                _config.save();
-            }
-            else{
+                data_path(inData,num),
+                data_path(outData,num));
+            res=retime(_baseProgramPath/f(Test_Code),args,data_path(inData,num),data_path(outData,num),limit(),res,dataName);
+            report_retime(res.retimed);
+            report_budget(res.wallBudget);
+            // 超时和运行错误默认中止对拍,开启 continue_on_failure 时作为判题结果,由 judge 区分
+            if(res.status!=process::STOP&&!_config.value().value(f(ContinueOnFailure),false)){
                 _testlog.tlog(info+": 测试代码运行失败,错误信息: "+res.error,loglib::ERROR);
                 return false;
             }
-            // 运行对应的AC代码
-            args.clear();
-            args.add(f(AC_Code));
-            res=run(_baseProgramPath/f(AC_Code),
-                args,
-                _dataDirs[inData]/(dataName+".in"),
-                _dataDirs[acData]/(dataName+".out"));
-            if(res.status==process::STOP){
-                _testlog.tlog(info+": AC代码已运行");
-                temp=judge(res.status,res.exit_code);
-                if(temp!=Waiting){
-                    _testlog.tlog("AC代码出现问题, 状态: "+f(temp)+
-                        "错误信息: "+res.error
-                        ,loglib::ERROR);
-                    return false;
-                }
+            JudgeCode temp=judge(res.status,res.exit_code),verdict=temp;
+            // 测试代码的运行时间
+            int testTime=res.time;
+            _testlog.tlog(info+": 测试代码已运行");
+            if(limit().counters){
+                json line={
+                    { "name",dataName },
+                    { "time",res.time },
+                    { "wall",res.wall },
+                    { "memory",res.memory },
+                    { "cpu",res.cpu },
+                    { "counters",counters_json(res.counters) }
+                };
+                append_to(_baseConfigPath/"stats.jsonl",line.dump()+"\n");
+            }
+            progress({
+                { f(DataNum),dataName },
+                { f(JudgeStatus),f(temp) }
+                });
+            // 标准输出仍然有效时直接复用
+            if(reuse_ac(num)){
+                _testlog.tlog(info+": 复用AC代码输出");
+                store_data(outData,num);
             }
             else{
-                _testlog.tlog(info+": AC代码运行失败,错误信息: "+res.error,loglib::ERROR);
-                return false;
+                // 运行对应的AC代码
+                args.clear();
+                args.add(f(AC_Code));
+                res=run(_baseProgramPath/f(AC_Code),
+                    args,
+                    data_path(inData,num),
+                    data_path(acData,num));
+                if(res.status==process::STOP){
+                    _testlog.tlog(info+": AC代码已运行");
+                    store_data(outData,num);
+                    store_data(acData,num);
+                    temp=judge(res.status,res.exit_code);
+                    if(temp!=Waiting){
+                        _testlog.tlog("AC代码出现问题, 状态: "+f(temp)+
+                            "错误信息: "+res.error
+                            ,loglib::ERROR);
+                        return false;
+                    }
+                }
+                else{
+                    _testlog.tlog(info+": AC代码运行失败,错误信息: "+res.error,loglib::ERROR);
+                    return false;
+                }
             }
+            // 参考解与AC代码交叉验证
+            json references=cross_check(num);
             // 如果已经判题
             if(_config[f(JudgeStatus)].get<string>()!=f(Waiting)){
                 _testlog.tlog("第"+std::to_string(num)+"个测试点,状态: "+string(_config[f(JudgeStatus)]),loglib::WARNING);
+                retain(num,verdict,testTime);
+                schedule(num,verdict,testTime);
+                report_references(num,references,verdict);
                 // 把当前样例加入错误集合
-                add_WAdatas();
-                _config[f(NowTest)]=num+1;
+                add_WAdatas(num,verdict);
+                progress({ { f(NowTest),num+1 } });
                 continue;
             }
             // 开始判题
             // 运行数据检查器
             args.clear();
-            args.add(f(Checkers)).add(_dataDirs[inData]/(dataName+".in")).add(_dataDirs[outData]/(dataName+".out")).add(_dataDirs[acData]/(dataName+".out"));
+            args.add(f(Checkers)).add(data_path(inData,num)).add(data_path(outData,num)).add(data_path(acData,num));
             // 运行数据检查器
             res=run(_baseProgramPath/f(Checkers),
                 args,
@@ -1367,10 +2601,15 @@ namespace acm{
                 "",
                 false);
             if(res.status==process::STOP){
-                _config[f(JudgeStatus)]=f(Accept);
                 _testlog.tlog(info+": "+f(Accept));
+                retain(num,Accept,testTime);
+                schedule(num,Accept,testTime);
+                report_references(num,references,Accept);
                 // 更新配置
-                _config[f(NowTest)]=num+1;
+                progress({
+                    { f(JudgeStatus),f(Accept) },
+                    { f(NowTest),num+1 }
+                    });
                 continue;
             }
             else if(res.status==process::ERROR){
@@ -1392,10 +2631,16 @@ namespace acm{
                         return false;
                     }
                     _testlog.tlog(info+": 状态 "+string(_config[f(JudgeStatus)]),loglib::WARNING);
+                    retain(num,actual_code==1?WrongAnswer:PresentationError,testTime);
+                    schedule(num,actual_code==1?WrongAnswer:PresentationError,testTime);
+                    report_references(num,references,actual_code==1?WrongAnswer:PresentationError);
                     // 当前样例添加到错误集合
-                    add_WAdatas();
+                    add_WAdatas(num,actual_code==1?WrongAnswer:PresentationError);
                     // 更新配置
-                    _config[f(NowTest)]=num+1;
+                    progress({
+                        { f(JudgeStatus),_config[f(JudgeStatus)] },
+                        { f(NowTest),num+1 }
+                        });
                     continue;
                 }
             }
@@ -1418,10 +2663,14 @@ namespace acm{
             }
         }
         while(num++);
+        if(!_references.empty()){
+            _testlog.tlog("判题矩阵: "+_referenceState.value().value("matrix",json::object()).dump());
+        }
         return true;
     }
     // 开始自动对拍
     bool AutoTest::start(){
+        check_calibration();
         // 开始运行
         // 循环验证数据直到找到不一致的数据
         int error_nums=_config[f(ErrorLimit)];
@@ -1444,57 +2693,1510 @@ namespace acm{
             }
         }
     }
-    // 添加错误集合
-    void AutoTest::add_WAdatas(){
-        string dataName=_config[f(DataNum)];
-        string in=rfile(_dataDirs[inData]/(dataName+".in"));
-        string out=rfile(_dataDirs[acData]/(dataName+".out"));
-        // 添加到错误样例集合
-        json temp={
-            { "in",in },
-            { "out",out }
+    // 对一组输入和标准输出运行测试代码和检查器
+    JudgeCode AutoTest::judge_case(const fs::path &in,const fs::path &out,const fs::path &ans,const Limit &limit,Exit &res,bool repeat){
+        process::Args args;
+        args.add(f(Test_Code));
+        res=run(_baseProgramPath/f(Test_Code),args,in,out,limit);
+        if(repeat){
+            res=retime(_baseProgramPath/f(Test_Code),args,in,out,limit,res,in.stem().string());
+        }
+        JudgeCode verdict=judge(res.status,res.exit_code);
+        if(verdict!=Waiting){
+            return verdict;
+        }
+        return check_case(in,out,ans,res);
+    }
+    // 对已有的测试输出运行检查器
+    JudgeCode AutoTest::check_case(const fs::path &in,const fs::path &out,const fs::path &ans,Exit &res){
+        JudgeCode verdict;
+        process::Args args;
+        args.add(f(Checkers)).add(in).add(out).add(ans);
+        Exit check=run(_baseProgramPath/f(Checkers),args,"","",Limit());
+        res.error=check.error;
+        if(check.status==process::STOP){
+            verdict=Accept;
+        }
+        else if(check.status==process::ERROR&&WIFEXITED(check.exit_code)&&WEXITSTATUS(check.exit_code)==2){
+            verdict=PresentationError;
+        }
+        else if(check.status==process::ERROR&&WIFEXITED(check.exit_code)&&WEXITSTATUS(check.exit_code)==1){
+            verdict=WrongAnswer;
+        }
+        else{
+            // 检查器自身出错
+            verdict=Waiting;
+        }
+        return verdict;
+    }
+    // 并行重放错误样例集合
+    int AutoTest::replay_failures(){
+        json cases=_WAdatas.value();
+        if(cases.empty()){
+            return 0;
+        }
+        fs::path dir=_basePath/"work"/"replay";
+        fs::create_directories(dir);
+        for(size_t i=0; i<cases.size(); i++){
+            wfile(dir/(std::to_string(i)+".in"),cases[i]["in"].get<string>());
+            wfile(dir/(std::to_string(i)+".ans"),cases[i]["out"].get<string>());
+        }
+        struct Result{
+            JudgeCode verdict=Waiting;
+            Exit res;
         };
-        // 去重
-        if(std::find(_WAdatas.value().begin(),_WAdatas.value().end(),temp)!=_WAdatas.value().end()){
-            _testlog.tlog("错误样例已经存在,跳过添加",loglib::WARNING);
-            return;
+        std::vector<Result> results(cases.size());
+        Limit lim=limit();
+        // 工作线程只运行进程,不访问配置也不写日志
+        parallel_for(cases.size(),[&](size_t i){
+            fs::path base=dir/std::to_string(i);
+            results[i].verdict=judge_case(base.string()+".in",base.string()+".out",base.string()+".ans",lim,results[i].res);
+            });
+        int failed=0;
+        for(size_t i=0; i<results.size(); i++){
+            JudgeCode verdict=results[i].verdict;
+            string info="错误样例"+std::to_string(i+1)+": ";
+            report_retime(results[i].res.retimed);
+            report_budget(results[i].res.wallBudget);
+            if(verdict==Waiting){
+                _testlog.tlog(info+"检查器运行失败: "+results[i].res.error,loglib::ERROR);
+                failed++;
+            }
+            else if(verdict!=Accept){
+                _testlog.tlog(info+f(verdict)+" ("+std::to_string(results[i].res.time)+"ms)",loglib::WARNING);
+                failed++;
+            }
+            else{
+                _testlog.tlog(info+f(Accept)+" ("+std::to_string(results[i].res.time)+"ms)");
+            }
         }
-        _WAdatas.value().push_back(temp);
-        _WAdatas.save();
-        add_to_cph();
+        _testlog.tlog("错误样例重放完成: "+std::to_string(cases.size()-failed)+"/"+std::to_string(cases.size())+" 通过",
+            failed?loglib::WARNING:loglib::INFO);
+        return failed;
     }
-    string AutoTest::search_test_cph(){
-        // 如果cph路径被赋值才会执行
-        if(_cph=="."||_cph.empty()){
-            return "";
+    // 重放全部测试点
+    bool AutoTest::replay(bool stopFirst){
+        for(ConfigSign name:{ Test_Code,AC_Code,Checkers }){
+            if(!up_to_date(name,source(name))&&!ensure(name,source(name)).ok){
+                _testlog.tlog(f(name)+"编译失败,无法重放",loglib::ERROR);
+                return false;
+            }
         }
-        // 在cph文件夹中找到包含name的文件
-        std::vector<fs::path> matched_files;
-
-        string waitName=_config["origin_name"];
-        waitName="."+waitName+"_";
-        try{
-            // 遍历CPH文件夹中的所有文件
-            for(const auto &entry:fs::directory_iterator(_cph)){
-                // 检查是否是文件且文件名包含指定的字符串
-                if(fs::is_regular_file(entry)&&entry.path().filename().string().find(waitName)!=string::npos){
-                    matched_files.push_back(entry.path());
-                    _testlog.tlog("找到匹配的CPH文件: "+entry.path().string());
+        check_calibration();
+        // 测试点准备: 松散文件直接使用,打包存储的数据在工作线程中取出,缺少的输入和标准输出在工作线程中生成
+        struct Case{
+            string name;
+            fs::path in,ans;
+            // 按种子生成输入的参数,为空时输入已经存在
+            process::Args gen;
+            // 是否需要运行AC代码生成标准输出
+            bool needAC=false;
+            // 语料库中的编号,错误样例为0
+            int num=0;
+            // 是否已经开始运行,提前停止时没有运行的测试点不计入结果
+            bool ran=false;
+            JudgeCode verdict=Waiting;
+            Exit res;
+        };
+        fs::path dir=_basePath/"work"/"replay";
+        fs::remove_all(dir);
+        fs::create_directories(dir);
+        std::vector<Case> cases;
+        // 错误样例
+        for(size_t i=0; i<_WAdatas.value().size(); i++){
+            Case c;
+            c.name="WA"+std::to_string(i+1);
+            c.in=dir/(c.name+".in");
+            c.ans=dir/(c.name+".ans");
+            wfile(c.in,_WAdatas.value()[i]["in"].get<string>());
+            wfile(c.ans,_WAdatas.value()[i]["out"].get<string>());
+            cases.push_back(c);
+        }
+        // 上一次重放的结果
+        AutoConfig last(_baseConfigPath/"replay.json");
+        if(!last.value().is_object()){
+            last.value()=json::object();
+        }
+        // 语料库中之前错误的测试点排在前面,测试代码改变后判题结果被重置时参考上一次重放
+        std::vector<Case> failed,passed;
+        int target=_config[f(NowData)];
+        for(int num=1; num<=target; num++){
+            if(!has_data(num)){
+                continue;
+            }
+            Case c;
+            c.num=num;
+            c.name="data"+std::to_string(num);
+            bool wrong=false;
+            if(_packed){
+                CorpusRecord record=_corpus.record(num);
+                wrong=record.verdict>=0&&record.verdict!=Accept;
+                // 输入和标准输出在工作线程中取出
+                c.in=dir/(c.name+".in");
+                c.ans=dir/(c.name+".ans");
+                if(!_corpus.has(num,Slot_In)){
+                    string seed(record.seed,strnlen(record.seed,sizeof(record.seed)));
+                    c.gen.add(f(Generators)).add(record.mode).add(seed);
+                    if(record.scale>0){
+                        c.gen.add(record.scale).add(0);
+                    }
                 }
+                c.needAC=!_corpus.has(num,Slot_AC);
             }
-
-            if(matched_files.empty()){
-                _testlog.tlog("CPH: 未找到包含 "+_name+" 的CPH文件",loglib::WARNING);
-                return "";
+            else{
+                c.in=data_path(inData,num);
+                c.ans=data_path(acData,num);
+                c.needAC=!fs::exists(c.ans);
+                if(c.needAC){
+                    c.ans=dir/(c.name+".ans");
+                }
             }
+            wrong|=last.value().contains(c.name)&&last[c.name]["verdict"]!=f(Accept);
+            (wrong?failed:passed).push_back(c);
         }
-        catch(const std::exception &e){
-            _testlog.tlog("CPH: 查找文件时出错: "+string(e.what()),loglib::ERROR);
+        cases.insert(cases.end(),failed.begin(),failed.end());
+        cases.insert(cases.end(),passed.begin(),passed.end());
+        if(cases.empty()){
+            _testlog.tlog("没有可以重放的测试点",loglib::WARNING);
+            return true;
+        }
+        _testlog.tlog("开始重放"+std::to_string(cases.size())+"个测试点,其中之前错误的"+
+            std::to_string(_WAdatas.value().size()+failed.size())+"个优先");
+        _testlog.flush();
+        Limit lim=limit();
+        std::atomic<bool> stop{ false };
+        auto begin=std::chrono::steady_clock::now();
+        // 语料库的映射不是线程安全的,取出数据时加锁
+        std::mutex corpusLock;
+        auto replay_case=[&](Case &c){
+            if(c.num>0&&_packed){
+                try{
+                    std::lock_guard<std::mutex> guard(corpusLock);
+                    if(c.gen.size()==0){
+                        _corpus.get_file(c.num,Slot_In,c.in);
+                    }
+                    if(!c.needAC){
+                        _corpus.get_file(c.num,Slot_AC,c.ans);
+                    }
+                }
+                catch(const std::exception &e){
+                    c.res.error=string("读取语料库失败: ")+e.what();
+                    if(stopFirst){
+                        stop=true;
+                    }
+                    return;
+                }
+            }
+            if(c.gen.size()>0&&run(_baseProgramPath/f(Generators),c.gen,"",c.in,tool_limit()).status!=process::STOP){
+                c.res.error="按种子重新生成失败";
+                if(stopFirst){
+                    stop=true;
+                }
+                return;
+            }
+            if(c.needAC){
+                process::Args args;
+                args.add(f(AC_Code));
+                if(run(_baseProgramPath/f(AC_Code),args,c.in,c.ans,Limit()).status!=process::STOP){
+                    c.res.error="AC代码运行失败";
+                    if(stopFirst){
+                        stop=true;
+                    }
+                    return;
+                }
+            }
+            c.verdict=judge_case(c.in,dir/(c.name+".out"),c.ans,lim,c.res);
+            if(c.verdict==Waiting&&c.res.error.empty()){
+                c.res.error="检查器运行失败";
+            }
+            if(stopFirst&&c.verdict!=Accept){
+                stop=true;
+            }
+            };
+        parallel_for(cases.size(),[&](size_t i){
+            Case &c=cases[i];
+            if(stop){
+                return;
+            }
+            c.ran=true;
+            replay_case(c);
+            // 判题后删除临时文件,工作目录中只保留正在运行的测试点
+            std::error_code ec;
+            fs::remove(dir/(c.name+".out"),ec);
+            if(c.num>0&&(_packed||c.needAC)){
+                fs::remove(c.ans,ec);
+            }
+            if(c.num>0&&_packed){
+                fs::remove(c.in,ec);
+            }
+            });
+        auto cost=std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now()-begin).count();
+        // 与上一次重放比较
+        json now=json::object();
+        int total=0,accept=0,fixed=0,broken=0,slower=0,faster=0;
+        for(auto &c:cases){
+            if(!c.ran){
+                continue;
+            }
+            total++;
+            report_retime(c.res.retimed);
+            report_budget(c.res.wallBudget);
+            // 重新生成、AC代码或检查器失败的测试点没有判题结果,按失败计入
+            if(c.verdict==Waiting){
+                _testlog.tlog(c.name+": 运行失败: "+c.res.error,loglib::ERROR);
+                now[c.name]={ { "verdict",f(c.verdict) },{ "time",c.res.time },{ "error",c.res.error } };
+                if(last.value().contains(c.name)&&last[c.name]["verdict"]==f(Accept)){
+                    broken++;
+                }
+                continue;
+            }
+            accept+=c.verdict==Accept;
+            now[c.name]={ { "verdict",f(c.verdict) },{ "time",c.res.time } };
+            if(c.num>0&&_packed){
+                CorpusRecord record=_corpus.record(c.num);
+                record.verdict=c.verdict;
+                record.time=c.res.time;
+                _corpus.set_record(c.num,record);
+            }
+            if(!last.value().contains(c.name)){
+                if(c.verdict!=Accept){
+                    _testlog.tlog(c.name+": "+f(c.verdict)+" ("+std::to_string(c.res.time)+"ms)",loglib::WARNING);
+                }
+                continue;
+            }
+            string oldVerdict=last[c.name]["verdict"];
+            int oldTime=last[c.name]["time"];
+            string diff;
+            if(oldVerdict!=f(c.verdict)){
+                diff=oldVerdict+" -> "+f(c.verdict);
+                (c.verdict==Accept?fixed:broken)++;
+            }
+            // 用时变化超过20%且超过10ms才报告
+            int delta=c.res.time-oldTime;
+            if(std::abs(delta)>10&&std::abs(delta)*5>oldTime){
+                diff+=(diff.empty()?"":", ")+std::to_string(oldTime)+"ms -> "+std::to_string(c.res.time)+"ms";
+                (delta>0?slower:faster)++;
+            }
+            if(!diff.empty()){
+                _testlog.tlog(c.name+": "+diff,c.verdict==Accept?loglib::INFO:loglib::WARNING);
+            }
+        }
+        _testlog.tlog("重放完成: "+std::to_string(accept)+"/"+std::to_string(total)+" 通过, 用时"+std::to_string(cost)+"ms"+
+            "; 与上次相比: 修复"+std::to_string(fixed)+", 新错误"+std::to_string(broken)+
+            ", 变慢"+std::to_string(slower)+", 变快"+std::to_string(faster)+
+            (stop?"; 遇到错误已停止":""),
+            accept==total?loglib::INFO:loglib::WARNING);
+        // 提前停止时没有运行的测试点保留上一次的结果
+        last.value().update(now);
+        last.save();
+        return accept==total&&!stop;
+    }
+    // 测试代码与AC代码的用时比
+    double AutoTest::PerfCase::ratio() const{
+        return (double)testTime/std::max(acTime,1);
+    }
+    // 参数的唯一名称
+    string AutoTest::PerfCase::name() const{
+        return seed+"_"+std::to_string(scale)+"_"+std::to_string(shape);
+    }
+    // 运行一组性能测试参数
+    bool AutoTest::perf_case(PerfCase &c,const fs::path &dir,const Limit &lim){
+        fs::path base=dir/c.name();
+        fs::path ans=base.string()+".ans",out=base.string()+".out";
+        process::Args args;
+        if(c.in.empty()){
+            c.in=base.string()+".in";
+            args.add(f(Generators)).add(1).add(c.seed).add(c.scale).add(c.shape);
+            Exit res=run(_baseProgramPath/f(Generators),args,"",c.in,tool_limit());
+            if(res.status!=process::STOP){
+                c.error="数据生成器运行失败: "+res.error;
+                return false;
+            }
+            args.clear();
+            args.add(f(Validators));
+            res=run(_baseProgramPath/f(Validators),args,c.in,"",tool_limit());
+            if(res.status!=process::STOP){
+                c.error="数据验证失败: "+res.error;
+                return false;
+            }
+        }
+        args.clear();
+        args.add(f(AC_Code));
+        Exit res=run(_baseProgramPath/f(AC_Code),args,c.in,ans,Limit());
+        if(res.status!=process::STOP){
+            c.error="AC代码运行失败: "+res.error;
+            return false;
+        }
+        c.acTime=res.time;
+        c.verdict=judge_case(c.in,out,ans,lim,res);
+        c.testTime=res.time;
+        c.retimed=res.retimed;
+        c.wallBudget=res.wallBudget;
+        std::error_code ec;
+        fs::remove(ans,ec);
+        fs::remove(out,ec);
+        if(c.verdict==Waiting){
+            c.error="检查器运行失败: "+res.error;
+            return false;
+        }
+        return true;
+    }
+    // 搜索使测试代码相对AC代码最慢的输入
+    bool AutoTest::hunt(int rounds){
+        for(ConfigSign name:{ Generators,Validators,Checkers,Test_Code,AC_Code }){
+            if(!up_to_date(name,source(name))&&!ensure(name,source(name)).ok){
+                _testlog.tlog(f(name)+"编译失败,无法进行性能搜索",loglib::ERROR);
+                return false;
+            }
+        }
+        if(rounds<=0){
+            rounds=_config.value().value(f(HuntRounds),20);
+        }
+        int population=std::max(1,_config.value().value(f(HuntPopulation),8));
+        size_t keep=std::max(1,_config.value().value(f(PerfKeep),8));
+        fs::path dir=_basePath/"work"/"hunt";
+        fs::path perfDir=_basePath/"perf";
+        fs::create_directories(dir);
+        fs::create_directories(perfDir);
+        AutoConfig perf(_baseConfigPath/"perf.json");
+        if(!perf.value().contains("cases")){
+            perf.value()={ { "runs",0 },{ "cases",json::array() } };
+        }
+        Limit lim=limit();
+        // 用时比较: 先比较用时比,再比较测试代码的用时
+        auto slower=[](const PerfCase &a,const PerfCase &b){
+            if(a.ratio()!=b.ratio()){
+                return a.ratio()>b.ratio();
+            }
+            return a.testTime>b.testTime;
+            };
+        std::vector<PerfCase> elite;
+        std::set<string> seen;
+        // 先重测已有的性能语料,与上一次的用时比较
+        json old=perf["cases"];
+        if(!old.empty()){
+            std::vector<PerfCase> batch(old.size());
+            for(size_t i=0; i<old.size(); i++){
+                batch[i].seed=old[i]["seed"];
+                batch[i].scale=old[i]["scale"];
+                batch[i].shape=old[i]["shape"];
+                batch[i].in=perfDir/(batch[i].name()+".in");
+                if(!fs::exists(batch[i].in)){
+                    batch[i].in.clear();
+                }
+            }
+            parallel_for(batch.size(),[&](size_t i){
+                perf_case(batch[i],dir,lim);
+                });
+            for(size_t i=0; i<batch.size(); i++){
+                PerfCase &c=batch[i];
+                report_retime(c.retimed);
+                report_budget(c.wallBudget);
+                if(!c.error.empty()){
+                    _testlog.tlog("性能语料 "+c.name()+": "+c.error,loglib::WARNING);
+                    continue;
+                }
+                int oldTime=old[i]["test_time"];
+                int delta=c.testTime-oldTime;
+                // 用时变化超过20%且超过10ms才报告
+                if(std::abs(delta)>10&&std::abs(delta)*5>oldTime){
+                    _testlog.tlog("性能语料 "+c.name()+": "+std::to_string(oldTime)+"ms -> "+std::to_string(c.testTime)+"ms",
+                        delta>0?loglib::WARNING:loglib::INFO);
+                }
+                seen.insert(c.name());
+                elite.push_back(c);
+            }
+        }
+        // 每次搜索使用新的随机流,结果仍然只取决于主种子和搜索次数
+        int runs=perf["runs"];
+        CounterRng rng(derive(_master,runs,Stream_Hunt));
+        for(int round=1; round<=rounds; round++){
+            std::vector<PerfCase> batch;
+            for(int tries=0; (int)batch.size()<population&&tries<population*4; tries++){
+                PerfCase c;
+                // 四分之一为新种子,其余在较慢的参数附近变异
+                if(elite.empty()||rng.below(4)==0){
+                    c.seed=random_string(8,rng.next());
+                    c.shape=rng.below(4);
+                }
+                else{
+                    const PerfCase &parent=elite[rng.below(std::min<size_t>(elite.size(),3))];
+                    c.seed=parent.seed;
+                    c.scale=parent.scale;
+                    c.shape=parent.shape;
+                    switch(rng.below(3)){
+                    case 0:
+                        c.seed=random_string(8,rng.next());
+                        break;
+                    case 1:
+                        c.scale=std::clamp(c.scale+(int)rng.below(401)-200,1,1000);
+                        break;
+                    default:
+                        c.shape=std::max(0,c.shape+(rng.below(2)?1:-1));
+                        break;
+                    }
+                }
+                if(seen.insert(c.name()).second){
+                    batch.push_back(c);
+                }
+            }
+            parallel_for(batch.size(),[&](size_t i){
+                perf_case(batch[i],dir,lim);
+                });
+            for(auto &c:batch){
+                report_retime(c.retimed);
+                report_budget(c.wallBudget);
+                if(c.error.empty()){
+                    elite.push_back(c);
+                }
+                else{
+                    std::error_code ec;
+                    fs::remove(c.in,ec);
+                }
+            }
+            std::stable_sort(elite.begin(),elite.end(),slower);
+            // 淘汰的候选删除输入文件,性能语料中的文件最后统一处理
+            while(elite.size()>keep){
+                if(elite.back().in.parent_path()==dir){
+                    std::error_code ec;
+                    fs::remove(elite.back().in,ec);
+                }
+                elite.pop_back();
+            }
+            if(!elite.empty()){
+                const PerfCase &best=elite.front();
+                char ratio[32];
+                snprintf(ratio,sizeof(ratio),"%.2f",best.ratio());
+                _testlog.tlog("性能搜索第"+std::to_string(round)+"轮: 最慢 "+best.name()+" "+
+                    std::to_string(best.testTime)+"ms / AC "+std::to_string(best.acTime)+"ms = "+ratio);
+            }
+        }
+        // 保存性能语料
+        json cases=json::array();
+        std::set<fs::path> files;
+        bool accept=true;
+        for(auto &c:elite){
+            fs::path file=perfDir/(c.name()+".in");
+            if(c.in!=file){
+                fs::copy_file(c.in,file,fs::copy_options::overwrite_existing);
+                std::error_code ec;
+                fs::remove(c.in,ec);
+            }
+            files.insert(file);
+            char ratio[32];
+            snprintf(ratio,sizeof(ratio),"%.2f",c.ratio());
+            cases.push_back({
+                { "seed",c.seed },
+                { "scale",c.scale },
+                { "shape",c.shape },
+                { "verdict",f(c.verdict) },
+                { "test_time",c.testTime },
+                { "ac_time",c.acTime },
+                { "ratio",c.ratio() }
+                });
+            _testlog.tlog("性能语料 "+c.name()+": "+f(c.verdict)+" "+std::to_string(c.testTime)+"ms / AC "+
+                std::to_string(c.acTime)+"ms = "+ratio,c.verdict==Accept?loglib::INFO:loglib::WARNING);
+            accept&=c.verdict==Accept;
+        }
+        for(const auto &entry:fs::directory_iterator(perfDir)){
+            if(entry.path().extension()==".in"&&!files.count(entry.path())){
+                fs::remove(entry.path());
+            }
+        }
+        perf["runs"]=runs+1;
+        perf["cases"]=cases;
+        perf.save();
+        return accept;
+    }
+    // 固定的CPU负载: 整数混合、排序和随机访问,与题目中常见的运算接近
+    static const char *BenchmarkSource=R"(#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+static uint64_t mix(uint64_t x){
+    x=(x^(x>>30))*0xbf58476d1ce4e5b9ull;
+    x=(x^(x>>27))*0x94d049bb133111ebull;
+    return x^(x>>31);
+}
+int main(){
+    std::vector<uint32_t> data(1<<18);
+    uint64_t x=1;
+    for(auto &value:data){
+        x=mix(x);
+        value=x;
+    }
+    std::sort(data.begin(),data.end());
+    for(int i=0; i<(1<<22); i++){
+        x=mix(x^data[(x>>7)&(data.size()-1)]);
+    }
+    printf("%llu\n",(unsigned long long)x);
+}
+)";
+    // 主机标识: 主机名、CPU型号和核数
+    static string host_id(){
+        char name[256]={ 0 };
+        gethostname(name,sizeof(name)-1);
+        string model;
+        std::ifstream cpuinfo("/proc/cpuinfo");
+        string line;
+        while(std::getline(cpuinfo,line)){
+            if(line.rfind("model name",0)==0){
+                model=line.substr(line.find(':')+1);
+                break;
+            }
+        }
+        return to_hex(hash_bytes(string(name)+"|"+model+"|"+std::to_string(std::thread::hardware_concurrency())));
+    }
+    // 主机改变时重新校准
+    void AutoTest::check_calibration(){
+        if(!_config.value().value(f(AutoCalibrate),true)){
+            return;
+        }
+        AutoConfig state(_baseConfigPath/"calibration.json");
+        if(state.value().value("host",string(""))==host_id()){
+            return;
+        }
+        _testlog.tlog("主机没有校准过,正在校准时间限制");
+        if(!calibrate()){
+            _testlog.tlog("校准失败,沿用当前的时间倍率",loglib::WARNING);
+        }
+    }
+    // 校准时间限制
+    bool AutoTest::calibrate(){
+        for(ConfigSign name:{ Generators,Validators,AC_Code }){
+            if(!up_to_date(name,source(name))&&!ensure(name,source(name)).ok){
+                _testlog.tlog(f(name)+"编译失败,无法校准",loglib::ERROR);
+                return false;
+            }
+        }
+        int repeat=std::max(1,_config.value().value(f(CalibrateRepeat),5));
+        fs::path dir=_basePath/"work"/"calibrate";
+        fs::create_directories(dir);
+        // 固定负载按AC代码的编译配置编译,与本程序的编译选项无关
+        fs::path benchmark=dir/"benchmark.cpp";
+        wfile(benchmark,BenchmarkSource);
+        CompileResult compiled=compile(benchmark,_baseProgramPath/"benchmark",profile(AC_Code));
+        if(!compiled.ok){
+            _testlog.tlog("编译固定负载失败\n编译错误信息: "+compiled.error,loglib::ERROR);
+            return false;
+        }
+        std::vector<double> samples;
+        for(int r=0; r<5; r++){
+            process::Args args;
+            args.add("benchmark");
+            Exit res=run(_baseProgramPath/"benchmark",args,"",dir/"benchmark.out",Limit());
+            if(res.status!=process::STOP){
+                _testlog.tlog("固定负载运行失败: "+res.error,loglib::ERROR);
+                return false;
+            }
+            samples.push_back(res.timeUs);
+        }
+        // 机器速度与参考机器的比值作为时间倍率
+        double hostUs=median(samples);
+        double referenceUs=_config.value().value(f(CalibrateReference),40000.0);
+        if(referenceUs<=0){
+            referenceUs=40000.0;
+        }
+        double scale=std::clamp(std::round(hostUs/referenceUs*20)/20,0.5,4.0);
+        // 在最大规模的边界数据上重复运行AC代码
+        std::vector<double> times;
+        long peak=0;
+        json inputs=json::array();
+        for(int i=0; i<repeat; i++){
+            fs::path in=dir/(std::to_string(i)+".in");
+            process::Args args;
+            string seed=random_string(8,derive(_master,i,Stream_Calibrate));
+            args.add(f(Generators)).add(1).add(seed).add(1000).add(0);
+            Exit res=run(_baseProgramPath/f(Generators),args,"",in,tool_limit());
+            if(res.status!=process::STOP){
+                _testlog.tlog("数据生成器运行失败: "+res.error,loglib::ERROR);
+                return false;
+            }
+            args.clear();
+            args.add(f(Validators));
+            if(run(_baseProgramPath/f(Validators),args,in,"",tool_limit()).status!=process::STOP){
+                continue;
+            }
+            samples.clear();
+            for(int r=0; r<repeat; r++){
+                args.clear();
+                args.add(f(AC_Code));
+                res=run(_baseProgramPath/f(AC_Code),args,in,dir/"ac.out",Limit());
+                if(res.status!=process::STOP){
+                    _testlog.tlog("AC代码运行失败: "+res.error,loglib::ERROR);
+                    return false;
+                }
+                samples.push_back(res.timeUs/1000.0);
+                peak=std::max(peak,res.memory);
+            }
+            times.push_back(median(samples));
+            inputs.push_back({ { "seed",seed },{ "bytes",fs::file_size(in) },{ "ac",times.back() } });
+        }
+        if(times.empty()){
+            _testlog.tlog("没有通过验证的最大规模数据,无法校准",loglib::ERROR);
+            return false;
+        }
+        double acTime=*std::max_element(times.begin(),times.end());
+        // AC代码最慢用时的3倍作为建议时间限制,峰值内存的2倍作为建议内存限制
+        int suggestedTime=std::max(100,(int)std::ceil(acTime*3/100)*100);
+        int suggestedMemory=std::max(16,(int)std::ceil(peak/1024.0*2/16)*16);
+        _config[f(TimeScale)]=scale;
+        checkpoint();
+        AutoConfig state(_baseConfigPath/"calibration.json");
+        state.value()={
+            { "host",host_id() },
+            { "benchmark_us",hostUs },
+            { "time_scale",scale },
+            { "ac_time",acTime },
+            { "ac_memory",peak },
+            { "suggested_time_limit",suggestedTime },
+            { "suggested_mem_limit",suggestedMemory },
+            { "inputs",inputs }
+        };
+        state.save();
+        Limit lim=limit();
+        char line[512];
+        bool applied=_config.value().value(f(ApplyTimeScale),false);
+        snprintf(line,sizeof(line),"校准结果: 机器速度为参考机器的%.2f倍, 建议时间倍率%.2f(%s), 实际时间限制%dms; AC代码最大规模用时%.2fms, "
+            "峰值内存%.1fMB; 建议时间限制%dms, 建议内存限制%dMB",
+            referenceUs/hostUs,scale,applied?"已启用":"开启 apply_time_scale 后生效",lim.time,acTime,peak/1024.0,suggestedTime,suggestedMemory);
+        _testlog.tlog(line);
+        if(lim.time>0&&acTime>lim.time*0.5){
+            _testlog.tlog("AC代码用时已超过时间限制的一半,测试代码的超时判定可能不可靠",loglib::WARNING);
+        }
+        if(lim.memory>0&&peak>lim.memory*1024*0.8){
+            _testlog.tlog("AC代码峰值内存接近内存限制",loglib::WARNING);
+        }
+        return true;
+    }
+    // 估计测试代码和AC代码的复杂度
+    bool AutoTest::complexity(){
+        for(ConfigSign name:{ Generators,Validators,Test_Code,AC_Code }){
+            if(!up_to_date(name,source(name))&&!ensure(name,source(name)).ok){
+                _testlog.tlog(f(name)+"编译失败,无法估计复杂度",loglib::ERROR);
+                return false;
+            }
+        }
+        int points=std::max(3,_config.value().value(f(ComplexityPoints),7));
+        int repeat=std::max(1,_config.value().value(f(ComplexityRepeat),5));
+        fs::path dir=_basePath/"work"/"complexity";
+        fs::create_directories(dir);
+        Limit lim=limit();
+        // 每个规模的输入大小和中位用时(ms)
+        struct Point{
+            int scale=0;
+            double bytes=0;
+            double test=0;
+            double ac=0;
+            // 测试代码超时或运行失败,不参与拟合
+            bool over=false;
+        };
+        std::vector<Point> result;
+        // 在一个规模上重复计时,取中位数
+        auto measure=[&](int scale,uint64_t index,Point &p){
+            string info="规模"+std::to_string(scale)+"‰";
+            fs::path in=dir/("scale"+std::to_string(scale)+".in");
+            process::Args args;
+            args.add(f(Generators)).add(1).add(random_string(8,derive(_master,index,Stream_Scale))).add(scale).add(0);
+            Exit res=run(_baseProgramPath/f(Generators),args,"",in,tool_limit());
+            if(res.status!=process::STOP){
+                _testlog.tlog(info+": 数据生成器运行失败: "+res.error,loglib::ERROR);
+                return false;
+            }
+            args.clear();
+            args.add(f(Validators));
+            res=run(_baseProgramPath/f(Validators),args,in,"",tool_limit());
+            if(res.status!=process::STOP){
+                _testlog.tlog(info+": 数据验证失败,生成器可能不支持规模参数: "+res.error,loglib::ERROR);
+                return false;
+            }
+            p.scale=scale;
+            p.bytes=fs::file_size(in);
+            std::vector<double> test,ac;
+            for(int r=0; r<repeat; r++){
+                args.clear();
+                args.add(f(AC_Code));
+                res=run(_baseProgramPath/f(AC_Code),args,in,dir/"ac.out",Limit());
+                if(res.status!=process::STOP){
+                    _testlog.tlog(info+": AC代码运行失败: "+res.error,loglib::ERROR);
+                    return false;
+                }
+                ac.push_back(res.timeUs/1000.0);
+                if(p.over){
+                    continue;
+                }
+                args.clear();
+                args.add(f(Test_Code));
+                res=run(_baseProgramPath/f(Test_Code),args,in,dir/"test.out",lim);
+                if(res.status!=process::STOP){
+                    p.over=true;
+                    continue;
+                }
+                test.push_back(res.timeUs/1000.0);
+            }
+            p.ac=median(ac);
+            p.test=p.over?lim.time:median(test);
+            char line[160];
+            snprintf(line,sizeof(line),": %.0f 字节, 测试代码 %s%.2fms, AC代码 %.2fms",p.bytes,p.over?">":"",p.test,p.ac);
+            _testlog.tlog(info+line,p.over?loglib::WARNING:loglib::INFO);
+            return true;
+            };
+        // 最小规模的用时近似为进程启动开销,拟合前从各规模中减去
+        Point base;
+        if(!measure(1,points,base)){
+            return false;
+        }
+        for(int k=0; k<points; k++){
+            // 规模千分比按2的幂递增,最后一个为最大规模
+            int scale=std::max(1,(int)std::lround(1000.0/std::pow(2.0,points-1-k)));
+            if(!result.empty()&&result.back().scale==scale){
+                continue;
+            }
+            Point p;
+            if(!measure(scale,k,p)){
+                return false;
+            }
+            result.push_back(p);
+        }
+        // 减去启动开销后用时太短的规模误差太大,不参与拟合
+        const double floor=1.0;
+        struct Estimate{
+            LinearFit fit;
+            // 参与拟合的最大点,外推以它为支点
+            double bytes=0,time=0;
+            // 最大规模的预计用时及其区间
+            double predict=0,low=0,high=0;
+        };
+        double maxBytes=result.back().bytes;
+        auto estimate=[&](bool isTest){
+            Estimate e;
+            std::vector<double> x,y;
+            for(const auto &p:result){
+                double t=isTest?p.test-base.test:p.ac-base.ac;
+                if((isTest&&p.over)||t<floor){
+                    continue;
+                }
+                x.push_back(std::log(p.bytes));
+                y.push_back(std::log(t));
+                e.bytes=p.bytes;
+                e.time=t;
+            }
+            e.fit=linear_fit(x,y);
+            if(e.fit.n==0){
+                return e;
+            }
+            double hw=std::isinf(e.fit.half_width())?0:e.fit.half_width();
+            double ratio=maxBytes/e.bytes;
+            double overhead=isTest?base.test:base.ac;
+            e.predict=overhead+e.time*std::pow(ratio,e.fit.slope);
+            e.low=overhead+e.time*std::pow(ratio,e.fit.slope-hw);
+            e.high=overhead+e.time*std::pow(ratio,e.fit.slope+hw);
+            return e;
+            };
+        Estimate test=estimate(true),ac=estimate(false);
+        json report={ { "overhead",{ { "test",base.test },{ "ac",base.ac } } },{ "points",json::array() } };
+        for(const auto &p:result){
+            report["points"].push_back({ { "scale",p.scale },{ "bytes",p.bytes },{ "test",p.test },{ "ac",p.ac },{ "over",p.over } });
+        }
+        bool ok=true;
+        auto describe=[&](const string &name,const string &key,const Estimate &e){
+            if(e.fit.n<2){
+                _testlog.tlog(name+": 减去启动开销后用时超过"+std::to_string((int)floor)+"ms的规模不足两个,无法估计",loglib::WARNING);
+                return;
+            }
+            char line[200];
+            if(e.fit.n<3){
+                snprintf(line,sizeof(line),": 用时约为输入大小的 %.2f 次方(只有两个点,没有置信区间), 最大规模预计 %.1fms",
+                    e.fit.slope,e.predict);
+            }
+            else{
+                snprintf(line,sizeof(line),": 用时约为输入大小的 %.2f 次方(95%%置信区间 %.2f~%.2f, R²=%.3f), 最大规模预计 %.1fms (%.1f~%.1fms)",
+                    e.fit.slope,e.fit.slope-e.fit.half_width(),e.fit.slope+e.fit.half_width(),e.fit.r2,e.predict,e.low,e.high);
+            }
+            _testlog.tlog(name+line);
+            report[key]={
+                { "slope",e.fit.slope },
+                { "half_width",e.fit.n<3?0:e.fit.half_width() },
+                { "r2",e.fit.r2 },
+                { "points",e.fit.n },
+                { "predict",e.predict },
+                { "low",e.low },
+                { "high",e.high }
+            };
+            };
+        describe("AC代码","ac",ac);
+        describe("测试代码","test",test);
+        if(test.fit.n>=2&&lim.time>0&&test.predict>lim.time){
+            _testlog.tlog("测试代码在最大规模下预计超过时间限制 "+std::to_string(lim.time)+"ms",loglib::WARNING);
+            ok=false;
+        }
+        if(test.fit.n>=2&&ac.fit.n>=2){
+            double testLow=test.fit.slope-(test.fit.n<3?0:test.fit.half_width());
+            double acHigh=ac.fit.slope+(ac.fit.n<3?0:ac.fit.half_width());
+            if(test.fit.n>=3&&ac.fit.n>=3&&testLow>acHigh){
+                _testlog.tlog("测试代码的增长明显快于AC代码,复杂度可能更高",loglib::WARNING);
+                ok=false;
+            }
+            else if(test.fit.slope>ac.fit.slope+0.5){
+                _testlog.tlog("测试代码的增长可能快于AC代码,置信区间重叠,可以增加 complexity_repeat 或 complexity_points",loglib::WARNING);
+            }
+        }
+        report["faster_than_ac"]=!ok;
+        AutoConfig file(_baseConfigPath/"complexity.json");
+        file.value()=report;
+        file.save();
+        return ok;
+    }
+    // 覆盖率引导的输入选择
+    bool AutoTest::coverage(int execs){
+        for(ConfigSign name:{ Generators,Validators,Checkers,Test_Code,AC_Code }){
+            if(!up_to_date(name,source(name))&&!ensure(name,source(name)).ok){
+                _testlog.tlog(f(name)+"编译失败,无法进入覆盖率引导模式",loglib::ERROR);
+                return false;
+            }
+        }
+        if(execs<=0){
+            execs=_config.value().value(f(CoverageExecs),2000);
+        }
+        // 插桩版本的测试代码,运行时桩代码按内容命名
+        string runtime=Coverage::runtime();
+        fs::path runtimeFile=_path/"coverage"/("runtime_"+to_hex(hash_bytes(runtime))+".cpp");
+        if(!fs::exists(runtimeFile)){
+            wfile(runtimeFile,runtime);
+        }
+        std::vector<string> flags=profile(Test_Code);
+        flags.push_back("-fsanitize-coverage=trace-pc");
+        flags.push_back(runtimeFile.string());
+        fs::path target=_baseProgramPath/(f(Test_Code)+"_cov");
+        CompileResult compiled=compile(_testfile,target,flags);
+        if(!compiled.ok){
+            _testlog.tlog("插桩编译测试代码失败\n编译错误信息: "+compiled.error,loglib::ERROR);
+            return false;
+        }
+        fs::path dir=_basePath/"work"/"coverage";
+        fs::create_directories(dir);
+        size_t population=std::max(4u,std::thread::hardware_concurrency());
+        std::vector<std::unique_ptr<CoverageMap>> maps;
+        for(size_t i=0; i<population; i++){
+            maps.push_back(std::make_unique<CoverageMap>());
+            maps.back()->open(dir/(std::to_string(i)+".map"));
+        }
+        // 累计覆盖率和队列在多次运行之间保留
+        Coverage total;
+        total.load(_baseConfigPath/"coverage.bin");
+        AutoConfig state(_baseConfigPath/"coverage.json");
+        if(!state.value().contains("queue")){
+            state.value()={
+                { "runs",0 },
+                { "execs",0 },
+                { "modes",{ 0,0,0 } },
+                { "mutations",{ 0,0,0 } },
+                { "queue",json::array() }
+            };
+        }
+        // 生成器参数,scale 为0时不传规模和形态
+        struct Case{
+            int mode=0;
+            string seed;
+            int scale=0;
+            int shape=0;
+            // 由哪种变异产生,-1 为新种子
+            int mutation=-1;
+            // 发现的新覆盖数量
+            size_t found=0;
+            bool ok=false;
+            JudgeCode verdict=Waiting;
+            string error;
+            // 重复计时的记录
+            json retimed;
+            // 指令数预算是否退回到墙钟时间
+            bool wallBudget=false;
+        };
+        std::vector<Case> queue;
+        for(const auto &item:state["queue"]){
+            Case c;
+            c.mode=item["mode"];
+            c.seed=item["seed"];
+            c.scale=item["scale"];
+            c.shape=item["shape"];
+            c.found=item["found"];
+            queue.push_back(c);
+        }
+        std::vector<int> modeFound=state["modes"].get<std::vector<int>>();
+        std::vector<int> mutationFound=state["mutations"].get<std::vector<int>>();
+        int runs=state["runs"];
+        CounterRng rng(derive(_master,runs,Stream_Coverage));
+        Limit lim=limit();
+        // 插桩版本较慢,放宽时间限制,出错时再用原版本确认
+        Limit covLimit=lim;
+        covLimit.time=lim.time>0?lim.time*5:0;
+        int errorLimit=_config[f(ErrorLimit)];
+        int failures=0;
+        size_t startEdges=total.edges();
+        _testlog.tlog("覆盖率引导模式: 已覆盖"+std::to_string(startEdges)+"条边,队列"+std::to_string(queue.size())+"个种子");
+        int done=0;
+        // 相同的生成器参数得到相同的输入,不重复运行
+        std::set<string> seen;
+        for(const auto &c:queue){
+            seen.insert(std::to_string(c.mode)+c.seed+"_"+std::to_string(c.scale)+"_"+std::to_string(c.shape));
+        }
+        while(done<execs&&failures<errorLimit){
+            std::vector<Case> batch;
+            for(size_t tries=0; batch.size()<population&&tries<population*4; tries++){
+                Case c;
+                // 三分之二从队列中按发现的新覆盖数量选择父代变异
+                if(!queue.empty()&&rng.below(3)!=0){
+                    std::vector<int> weights;
+                    for(const auto &q:queue){
+                        weights.push_back(1+(int)q.found);
+                    }
+                    c=queue[weighted_index(weights,rng.next())];
+                    c.found=0;
+                    std::vector<int> kinds;
+                    for(int found:mutationFound){
+                        kinds.push_back(1+found);
+                    }
+                    c.mutation=weighted_index(kinds,rng.next());
+                    switch(c.mutation){
+                    case 0:
+                        c.seed=random_string(8,rng.next());
+                        break;
+                    case 1:
+                        c.scale=std::clamp((c.scale>0?c.scale:1000)+(int)rng.below(401)-200,1,1000);
+                        break;
+                    default:
+                        c.scale=c.scale>0?c.scale:1000;
+                        c.shape=std::max(0,c.shape+(rng.below(2)?1:-1));
+                        break;
+                    }
+                }
+                else{
+                    std::vector<int> weights;
+                    for(int found:modeFound){
+                        weights.push_back(1+found);
+                    }
+                    c.mode=weighted_index(weights,rng.next());
+                    c.seed=random_string(8,rng.next());
+                }
+                if(seen.insert(std::to_string(c.mode)+c.seed+"_"+std::to_string(c.scale)+"_"+std::to_string(c.shape)).second){
+                    batch.push_back(c);
+                }
+            }
+            if(batch.empty()){
+                break;
+            }
+            parallel_for(batch.size(),[&](size_t i){
+                Case &c=batch[i];
+                fs::path base=dir/std::to_string(i);
+                fs::path in=base.string()+".in",out=base.string()+".out",ans=base.string()+".ans";
+                process::Args args;
+                args.add(f(Generators)).add(c.mode).add(c.seed);
+                if(c.scale>0){
+                    args.add(c.scale).add(c.shape);
+                }
+                Exit res=run(_baseProgramPath/f(Generators),args,"",in,tool_limit());
+                if(res.status!=process::STOP){
+                    c.error="数据生成器运行失败: "+res.error;
+                    return;
+                }
+                args.clear();
+                args.add(f(Validators));
+                if(run(_baseProgramPath/f(Validators),args,in,"",tool_limit()).status!=process::STOP){
+                    return;
+                }
+                args.clear();
+                args.add(f(AC_Code));
+                res=run(_baseProgramPath/f(AC_Code),args,in,ans,Limit());
+                if(res.status!=process::STOP){
+                    c.error="AC代码运行失败: "+res.error;
+                    return;
+                }
+                maps[i]->clear();
+                args.clear();
+                args.add(f(Test_Code));
+                res=run(target,args,in,out,covLimit,{ { CoverageEnv,maps[i]->path().string() } });
+                c.ok=true;
+                c.verdict=judge(res.status,res.exit_code);
+                if(c.verdict==Waiting){
+                    c.verdict=check_case(in,out,ans,res);
+                }
+                // 只用插桩版本得到的错误需要用原版本确认
+                if(c.verdict!=Accept){
+                    c.verdict=judge_case(in,out,ans,lim,res);
+                    c.error=res.error;
+                    c.retimed=res.retimed;
+                    c.wallBudget=res.wallBudget;
+                }
+                });
+            done+=batch.size();
+            for(size_t i=0; i<batch.size(); i++){
+                Case &c=batch[i];
+                report_retime(c.retimed);
+                report_budget(c.wallBudget);
+                if(!c.ok){
+                    if(!c.error.empty()){
+                        _testlog.tlog(c.error,loglib::ERROR);
+                        return false;
+                    }
+                    continue;
+                }
+                c.found=total.merge(maps[i]->data());
+                if(c.found>0){
+                    modeFound[c.mode]+=c.found;
+                    if(c.mutation>=0){
+                        mutationFound[c.mutation]+=c.found;
+                    }
+                    queue.push_back(c);
+                    _testlog.tlog("新覆盖"+std::to_string(c.found)+"条边,共"+std::to_string(total.edges())+"条: 模式"+
+                        std::to_string(c.mode)+" 种子"+c.seed+(c.scale>0?" 规模"+std::to_string(c.scale)+" 形态"+std::to_string(c.shape):""));
+                }
+                if(c.verdict==Waiting){
+                    _testlog.tlog("检查器运行失败: "+c.error,loglib::ERROR);
+                    return false;
+                }
+                if(c.verdict!=Accept){
+                    failures++;
+                    fs::path base=dir/std::to_string(i);
+                    _testlog.tlog("发现错误 "+f(c.verdict)+": 模式"+std::to_string(c.mode)+" 种子"+c.seed+
+                        (c.scale>0?" 规模"+std::to_string(c.scale)+" 形态"+std::to_string(c.shape):""),loglib::WARNING);
+                    add_WAdatas(rfile(base.string()+".in"),rfile(base.string()+".ans"),c.verdict);
+                }
+            }
+        }
+        // 队列只保留发现新覆盖最多的种子
+        std::stable_sort(queue.begin(),queue.end(),[](const Case &a,const Case &b){
+            return a.found>b.found;
+            });
+        if(queue.size()>256){
+            queue.resize(256);
+        }
+        json saved=json::array();
+        for(const auto &c:queue){
+            saved.push_back({ { "mode",c.mode },{ "seed",c.seed },{ "scale",c.scale },{ "shape",c.shape },{ "found",c.found } });
+        }
+        total.save(_baseConfigPath/"coverage.bin");
+        state["runs"]=runs+1;
+        state["execs"]=state["execs"].get<int>()+done;
+        state["modes"]=modeFound;
+        state["mutations"]=mutationFound;
+        state["queue"]=saved;
+        state.save();
+        _testlog.tlog("覆盖率引导结束: 新增"+std::to_string(total.edges()-startEdges)+"条边,共"+std::to_string(total.edges())+
+            "条, 发现错误"+std::to_string(failures)+"个",failures?loglib::WARNING:loglib::INFO);
+        return failures==0;
+    }
+    // 变异模式
+    bool AutoTest::mutate(int count){
+        for(ConfigSign name:{ Generators,Validators,Checkers,AC_Code }){
+            if(!up_to_date(name,source(name))&&!ensure(name,source(name)).ok){
+                _testlog.tlog(f(name)+"编译失败,无法进入变异模式",loglib::ERROR);
+                return false;
+            }
+        }
+        if(count<=0){
+            count=_config.value().value(f(MutateCount),200);
+        }
+        int last=_config.value().value(f(NowData),0);
+        // 以当前测试点数量派生密钥,多次运行得到不同的变异
+        Mutator mutator(derive(_master,last,Stream_Mutate));
+        std::set<uint64_t> seen;
+        auto add_seed=[&](const string &data){
+            if(!data.empty()&&seen.insert(hash_bytes(data)).second){
+                mutator.add(data);
+            }
+        };
+        // 错误样例和最小化结果优先作为种子
+        for(const auto &item:_WAdatas.value()){
+            add_seed(item.value("in",""));
+            add_seed(item.value("min_in",""));
+        }
+        // seed 策略下只有保存了数据的测试点可以作为种子
+        for(int num=1; num<=last; num++){
+            if(in_shard(num)&&(_packed?_corpus.has(num,Slot_In):fs::exists(data_path(inData,num)))){
+                add_seed(read_data(inData,num));
+            }
+        }
+        if(mutator.size()==0){
+            _testlog.tlog("没有可以变异的种子,请先生成数据",loglib::ERROR);
+            return false;
+        }
+        _testlog.tlog("变异模式: "+std::to_string(mutator.size())+"个种子,生成"+std::to_string(count)+"个变异");
+        std::vector<string> candidates;
+        int duplicate=0;
+        for(int i=0; i<count; i++){
+            string data=mutator.mutate();
+            if(seen.insert(hash_bytes(data)).second){
+                candidates.push_back(data);
+            }
+            else{
+                duplicate++;
+            }
+        }
+        // 并行运行验证器过滤不合法的变异
+        fs::path dir=_basePath/"work"/"mutate";
+        fs::create_directories(dir);
+        std::vector<char> valid(candidates.size(),0);
+        parallel_for(candidates.size(),[&](size_t i){
+            fs::path in=dir/(std::to_string(i)+".in");
+            wfile(in,candidates[i]);
+            process::Args args;
+            args.add(f(Validators));
+            valid[i]=run(_baseProgramPath/f(Validators),args,in,"",tool_limit()).status==process::STOP;
+        });
+        // 合法的变异按顺序追加为新测试点
+        int accepted=0,num=last;
+        for(size_t i=0; i<candidates.size(); i++){
+            if(!valid[i]){
+                continue;
+            }
+            num++;
+            while(!in_shard(num)){
+                num++;
+            }
+            wfile(data_path(inData,num),candidates[i]);
+            store_data(inData,num,true);
+            if(_packed){
+                CorpusRecord record=_corpus.record(num);
+                record.flags|=Record_Mutant;
+                record.mode=-1;
+                record.verdict=-1;
+                record.genHash=0;
+                _corpus.set_record(num,record);
+                _workData=num;
+            }
+            accepted++;
+        }
+        int rejected=candidates.size()-accepted;
+        _testlog.tlog("变异结果: 生成"+std::to_string(count)+"个, 重复"+std::to_string(duplicate)+
+            "个, 验证器拒绝"+std::to_string(rejected)+"个, 新增测试点"+std::to_string(accepted)+"个");
+        if(accepted==0){
+            return true;
+        }
+        progress({
+            { f(NowData),num },
+            { f(DataNum),"data"+std::to_string(num) }
+            });
+        // 按正常对拍流程测试新测试点
+        size_t before=_WAdatas.value().size();
+        bool ok=test_data();
+        size_t found=_WAdatas.value().size()-before;
+        _testlog.tlog("变异模式结束: 发现新的错误样例"+std::to_string(found)+"个",found?loglib::WARNING:loglib::INFO);
+        return ok;
+    }
+    // 监视测试代码
+    bool AutoTest::watch(){
+        ai_gen();
+        if(!up_to_date(Generators,source(Generators))||!up_to_date(Validators,source(Validators))||!up_to_date(Checkers,source(Checkers))){
+            _testlog.tlog("测试工具没有准备好,无法进入监视模式",loglib::ERROR);
+            return false;
+        }
+        int fd=inotify_init1(IN_CLOEXEC|IN_NONBLOCK);
+        if(fd==-1){
+            _testlog.tlog("inotify初始化失败: "+string(strerror(errno)),loglib::ERROR);
+            return false;
+        }
+        // 监视文件夹,编辑器保存时可能先写临时文件再改名
+        fs::path dir=_testfile.parent_path().empty()?fs::path("."):_testfile.parent_path();
+        if(inotify_add_watch(fd,dir.c_str(),IN_CLOSE_WRITE|IN_MOVED_TO)==-1){
+            _testlog.tlog("无法监视文件夹: "+dir.string()+" - "+strerror(errno),loglib::ERROR);
+            ::close(fd);
+            return false;
+        }
+        _testlog.tlog("监视模式: 正在监视 "+_testfile.string());
+        bool changed=true;
+        bool stress=false;
+        int error_nums=0;
+        while(true){
+            if(changed){
+                changed=false;
+                stress=false;
+                auto begin=std::chrono::steady_clock::now();
+                CompileResult res=ensure(Test_Code,_testfile);
+                if(!res.ok){
+                    _testlog.tlog("测试代码编译失败,等待下一次保存",loglib::ERROR);
+                }
+                else{
+                    // 只重放错误样例,已保存测试点的判题结果不在这里清除;依赖记录保持不变,下次完整运行时再重新判题
+                    int failed=replay_failures();
+                    auto cost=std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now()-begin).count();
+                    _testlog.tlog("从保存到重放完成用时 "+std::to_string(cost)+"ms");
+                    _log.flush();
+                    _testlog.flush();
+                    // 已知错误仍然存在时等待修改,否则先判定还没有判题的测试点再继续对拍
+                    if(failed==0){
+                        error_nums=_config[f(ErrorLimit)];
+                        stress=true;
+                    }
+                }
+            }
+            // 对拍时不阻塞,否则一直等待文件改变
+            struct pollfd pfd{ fd,POLLIN,0 };
+            int ready=::poll(&pfd,1,stress?0:-1);
+            if(ready<0&&errno!=EINTR){
+                break;
+            }
+            if(ready>0){
+                // 合并短时间内的多次保存事件
+                std::this_thread::sleep_for(std::chrono::milliseconds(30));
+                alignas(struct inotify_event) char buffer[4096];
+                ssize_t n;
+                while((n=::read(fd,buffer,sizeof(buffer)))>0){
+                    for(char *p=buffer; p<buffer+n;){
+                        auto *event=reinterpret_cast<struct inotify_event *>(p);
+                        if(event->len>0&&_testfile.filename()==event->name){
+                            changed=true;
+                        }
+                        p+=sizeof(struct inotify_event)+event->len;
+                    }
+                }
+                if(changed){
+                    _testlog.tlog("检测到测试代码改变");
+                }
+                continue;
+            }
+            if(!stress){
+                continue;
+            }
+            // 对拍一个测试点
+            if(!generate_data()||!test_data()){
+                _testlog.tlog("对拍出错,等待下一次保存",loglib::ERROR);
+                stress=false;
+                continue;
+            }
+            if(_config[f(JudgeStatus)]!=f(Accept)){
+                error_nums--;
+                if(error_nums<=0){
+                    _testlog.tlog("错误限制达到,等待下一次保存",loglib::WARNING);
+                    _testlog.flush();
+                    stress=false;
+                }
+            }
+        }
+        ::close(fd);
+        return false;
+    }
+    // 最小化错误样例
+    string AutoTest::minimize(const string &in,JudgeCode verdict,string &out){
+        fs::path dir=_basePath/"work"/"minimize";
+        fs::create_directories(dir);
+        Limit lim=limit();
+        std::atomic<size_t> counter{ 0 };
+        // 候选数据需要通过验证器,且测试代码得到相同的判题结果
+        // 判定函数在多个线程中同时调用,不访问配置也不写日志;只需要判题结果相同,不重复计时
+        Reducer::Oracle oracle=[&](const string &data){
+            fs::path base=dir/std::to_string(counter++);
+            fs::path inFile=base.string()+".in",ansFile=base.string()+".ans",outFile=base.string()+".out";
+            wfile(inFile,data);
+            bool ok=false;
+            process::Args args;
+            args.add(f(Validators));
+            Exit res=run(_baseProgramPath/f(Validators),args,inFile,"",tool_limit());
+            if(res.status==process::STOP){
+                args.clear();
+                args.add(f(AC_Code));
+                res=run(_baseProgramPath/f(AC_Code),args,inFile,ansFile,lim);
+                if(res.status==process::STOP&&judge(res.status,res.exit_code)==Waiting){
+                    ok=judge_case(inFile,outFile,ansFile,lim,res,false)==verdict;
+                }
+            }
+            std::error_code ec;
+            for(const auto &file:{ inFile,ansFile,outFile }){
+                fs::remove(file,ec);
+            }
+            return ok;
+            };
+        int jobs=std::max(1u,std::thread::hardware_concurrency());
+        Reducer reducer(oracle,jobs);
+        reducer.set_budget(_config.value().value(f(MinimizeBudget),1000));
+        string result=reducer.reduce(in);
+        // 生成最小样例的标准输出
+        fs::path inFile=dir/"min.in",ansFile=dir/"min.ans";
+        wfile(inFile,result);
+        process::Args args;
+        args.add(f(AC_Code));
+        Exit res=run(_baseProgramPath/f(AC_Code),args,inFile,ansFile,lim);
+        if(res.status!=process::STOP){
+            _testlog.tlog("最小样例的AC代码运行失败,保留原样例: "+res.error,loglib::WARNING);
+            out.clear();
+            return in;
+        }
+        out=rfile(ansFile);
+        _testlog.tlog("错误样例已最小化: "+std::to_string(in.size())+" -> "+std::to_string(result.size())+
+            " 字节,判定 "+std::to_string(reducer.tests())+" 次");
+        return result;
+    }
+    // 诊断失败的样例
+    string AutoTest::diagnose(const string &in,JudgeCode verdict){
+        fs::path dir=_basePath/"work"/"diagnose";
+        fs::create_directories(dir);
+        fs::path inFile=dir/"case.in",outFile=dir/"case.out",massifFile=dir/"massif.out";
+        wfile(inFile,in);
+        // 诊断运行不限制内存,消毒器和 valgrind 运行较慢,时间限制放宽
+        Limit lim;
+        lim.time=limit().time*10;
+        string report;
+        process::Args args;
+        std::error_code ec;
+        if(verdict==MemoryLimitExceeded){
+            fs::path valgrind=Diagnosis::which("valgrind");
+            if(!valgrind.empty()){
+                fs::remove(massifFile,ec);
+                args.add("valgrind");
+                args.add("--tool=massif");
+                args.add("--massif-out-file="+massifFile.string());
+                args.add((_baseProgramPath/f(Test_Code)).string());
+                run(valgrind,args,inFile,outFile,lim);
+                if(fs::exists(massifFile)){
+                    report+=Diagnosis::massif_report(rfile(massifFile));
+                }
+            }
+            if(report.empty()){
+                // 没有 massif 时报告不限制内存运行的峰值常驻内存
+                args.clear();
+                args.add(f(Test_Code));
+                Exit res=run(_baseProgramPath/f(Test_Code),args,inFile,outFile,lim);
+                char buffer[128];
+                snprintf(buffer,sizeof(buffer),"峰值常驻内存 %.1f MB,内存限制 %d MB\n",res.memory/1024.0,limit().memory);
+                report+=buffer;
+            }
+        }
+        // 消毒器版本只在诊断时编译,编译缓存保证只编译一次
+        std::vector<string> flags=profile(Test_Code);
+        for(const string &flag:Diagnosis::sanitizer_flags()){
+            flags.push_back(flag);
+        }
+        fs::path target=_baseProgramPath/(f(Test_Code)+"_asan");
+        CompileResult compiled=compile(_testfile,target,flags);
+        if(!compiled.ok){
+            _testlog.tlog("消毒器版本编译失败,跳过诊断\n编译错误信息: "+compiled.error,loglib::WARNING);
+            return report;
+        }
+        args.clear();
+        args.add(target.filename().string());
+        Exit res=run(target,args,inFile,outFile,lim,Diagnosis::sanitizer_env());
+        string found=Diagnosis::sanitizer_report(res.report);
+        if(found.empty()){
+            found=res.status==process::TIMEOUT?"消毒器版本运行超时,没有发现错误\n":"消毒器没有发现内存错误或未定义行为\n";
+        }
+        report+=found;
+        for(const auto &file:{ inFile,outFile,massifFile }){
+            fs::remove(file,ec);
+        }
+        return report;
+    }
+    // 最小化错误样例集合中还没有最小化的样例
+    bool AutoTest::minimize_failures(){
+        for(ConfigSign name:{ Test_Code,AC_Code,Validators,Checkers }){
+            if(!up_to_date(name,source(name))&&!ensure(name,source(name)).ok){
+                _testlog.tlog(f(name)+"编译失败,无法最小化",loglib::ERROR);
+                return false;
+            }
+        }
+        json &cases=_WAdatas.value();
+        fs::path dir=_basePath/"work"/"minimize";
+        fs::create_directories(dir);
+        for(size_t i=0; i<cases.size(); i++){
+            string info="错误样例"+std::to_string(i+1)+": ";
+            if(cases[i].contains("min_in")){
+                _testlog.tlog(info+"已经最小化,跳过");
+                continue;
+            }
+            // 当前测试代码的判题结果作为目标
+            wfile(dir/"origin.in",cases[i]["in"].get<string>());
+            wfile(dir/"origin.ans",cases[i]["out"].get<string>());
+            Exit res;
+            JudgeCode verdict=judge_case(dir/"origin.in",dir/"origin.out",dir/"origin.ans",limit(),res);
+            report_retime(res.retimed);
+            report_budget(res.wallBudget);
+            if(verdict==Accept||verdict==Waiting){
+                _testlog.tlog(info+"当前测试代码没有复现错误,跳过",loglib::WARNING);
+                continue;
+            }
+            string out;
+            string in=minimize(cases[i]["in"].get<string>(),verdict,out);
+            if(out.empty()){
+                continue;
+            }
+            cases[i]["min_in"]=in;
+            cases[i]["min_out"]=out;
+            _WAdatas.save();
+            add_to_cph({ { "in",in },{ "out",out } });
+        }
+        return true;
+    }
+    // 添加错误集合
+    void AutoTest::add_WAdatas(int num,JudgeCode verdict){
+        add_WAdatas(read_data(inData,num),read_data(acData,num),verdict);
+    }
+    void AutoTest::add_WAdatas(const string &in,const string &out,JudgeCode verdict){
+        // 添加到错误样例集合
+        json temp={
+            { "in",in },
+            { "out",out }
+        };
+        // 去重
+        auto same=[&](const json &item){
+            return item["in"]==temp["in"]&&item["out"]==temp["out"];
+            };
+        if(std::find_if(_WAdatas.value().begin(),_WAdatas.value().end(),same)!=_WAdatas.value().end()){
+            _testlog.tlog("错误样例已经存在,跳过添加",loglib::WARNING);
+            return;
+        }
+        // 最小化后推送到CPH的是最小样例
+        json test=temp;
+        if(_config.value().value(f(Minimize),true)&&fs::exists(_baseProgramPath/f(Validators))){
+            string minOut;
+            string minIn=minimize(in,verdict,minOut);
+            if(!minOut.empty()){
+                temp["min_in"]=minIn;
+                temp["min_out"]=minOut;
+                test={ { "in",minIn },{ "out",minOut } };
+            }
+        }
+        // 超时的样例在消毒器下只会更慢,不做诊断
+        if(_config.value().value(f(Diagnose),true)&&verdict!=TimeLimitEXceeded){
+            string report=diagnose(test["in"].get<string>(),verdict);
+            if(!report.empty()){
+                temp["diagnosis"]=report;
+                _testlog.tlog("错误样例诊断:\n"+report);
+            }
+        }
+        _WAdatas.value().push_back(temp);
+        _WAdatas.save();
+        add_to_cph(test);
+    }
+    string AutoTest::search_test_cph(){
+        // 如果cph路径被赋值才会执行
+        if(_cph=="."||_cph.empty()){
+            return "";
+        }
+        // 在cph文件夹中找到包含name的文件
+        std::vector<fs::path> matched_files;
+
+        string waitName=_config["origin_name"];
+        waitName="."+waitName+"_";
+        try{
+            // 遍历CPH文件夹中的所有文件
+            for(const auto &entry:fs::directory_iterator(_cph)){
+                // 检查是否是文件且文件名包含指定的字符串
+                if(fs::is_regular_file(entry)&&entry.path().filename().string().find(waitName)!=string::npos){
+                    matched_files.push_back(entry.path());
+                    _testlog.tlog("找到匹配的CPH文件: "+entry.path().string());
+                }
+            }
+
+            if(matched_files.empty()){
+                _testlog.tlog("CPH: 未找到包含 "+_name+" 的CPH文件",loglib::WARNING);
+                return "";
+            }
+        }
+        catch(const std::exception &e){
+            _testlog.tlog("CPH: 查找文件时出错: "+string(e.what()),loglib::ERROR);
         }
         return matched_files[0];
     }
-    void AutoTest::add_to_cph(){
-        if(_config["cph_file"].empty()){
+    void AutoTest::add_to_cph(const json &test){
+        if(!_config["cph_file"].is_string()||_config["cph_file"].get<string>().empty()){
             return;
         }
         // 以json的方式打开这个文件
@@ -1508,14 +4210,11 @@ namespace acm{
             cph_json=json::parse(file_content);
             // 添加测试数据
             if(cph_json.contains("tests")){
-                // 读取错误样例集合最后一个
-                json temp=_WAdatas.value().back();
-
                 // 创建新的测试用例
                 json new_test={
                     { "id",cph_json["tests"].size()+1 },
-                    { "input",temp["in"] },
-                    { "output",temp["out"] }
+                    { "input",test["in"] },
+                    { "output",test["out"] }
                 };
                 // 如果已经存在则不添加
                 if(std::find(cph_json.begin(),cph_json.end(),new_test)!=cph_json.end()){
@@ -1547,7 +4246,7 @@ namespace acm{
         _history.save();
         // 保存配置文件
         _setting.save();
-        _config.save();
+        checkpoint();
         // 保存错误样例集合
         _WAdatas.save();
     }
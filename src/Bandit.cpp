@@ -0,0 +1,146 @@
+#include "Bandit.h"
+#include "Random.h"
+#include <cmath>
+
+namespace acm{
+    // (0,1) 范围内的均匀分布
+    static double uniform(CounterRng &rng){
+        return ((rng.next()>>11)+0.5)*(1.0/9007199254740992.0);
+    }
+    // 标准正态分布, Box-Muller 变换
+    static double normal(CounterRng &rng){
+        double u=uniform(rng),v=uniform(rng);
+        return std::sqrt(-2*std::log(u))*std::cos(2*M_PI*v);
+    }
+    // Gamma(shape,1) 分布, Marsaglia-Tsang 方法
+    static double gamma(CounterRng &rng,double shape){
+        if(shape<1){
+            return gamma(rng,shape+1)*std::pow(uniform(rng),1/shape);
+        }
+        double d=shape-1.0/3,c=1/std::sqrt(9*d);
+        while(true){
+            double x=normal(rng),v=1+c*x;
+            if(v<=0){
+                continue;
+            }
+            v=v*v*v;
+            double u=uniform(rng);
+            if(std::log(u)<0.5*x*x+d-d*v+d*std::log(v)){
+                return d*v;
+            }
+        }
+    }
+    // Beta(a,b) 分布
+    static double beta(CounterRng &rng,double a,double b){
+        double x=gamma(rng,a),y=gamma(rng,b);
+        return x/(x+y);
+    }
+    // 平均耗时
+    double Bandit::Arm::mean_cost() const{
+        return pulls>0&&cost>0?std::max(1.0,cost/pulls):1.0;
+    }
+    // 构造函数
+    Bandit::Bandit(Policy policy):_policy(policy){}
+    // 按名称解析策略
+    Bandit::Policy Bandit::parse(const string &name){
+        if(name=="thompson"){
+            return Thompson;
+        }
+        if(name=="ucb"){
+            return UCB;
+        }
+        throw std::runtime_error("Bandit: 未知的调度策略: "+name);
+    }
+    // 添加臂
+    size_t Bandit::add_arm(const string &name){
+        Arm arm;
+        arm.name=name;
+        _arms.push_back(arm);
+        return _arms.size()-1;
+    }
+    // 臂的数量
+    size_t Bandit::size() const{
+        return _arms.size();
+    }
+    // 臂的统计
+    const Bandit::Arm &Bandit::arm(size_t index) const{
+        return _arms.at(index);
+    }
+    // 选择臂
+    size_t Bandit::select(uint64_t key) const{
+        CounterRng rng(key);
+        double total=0;
+        for(const auto &arm:_arms){
+            total+=arm.pulls;
+        }
+        size_t best=0;
+        double bestScore=-1;
+        for(size_t i=0; i<_arms.size(); i++){
+            const Arm &arm=_arms[i];
+            double rate;
+            if(_policy==Thompson){
+                // 错误率的后验 Beta(1+错误,1+其他)
+                rate=beta(rng,1+arm.failures,1+arm.pulls-arm.failures);
+            }
+            else{
+                // 没有运行过的臂优先尝试
+                if(arm.pulls<1){
+                    return i;
+                }
+                rate=arm.failures/arm.pulls+std::sqrt(2*std::log(std::max(1.0,total))/arm.pulls);
+            }
+            double score=rate/arm.mean_cost();
+            if(score>bestScore){
+                best=i;
+                bestScore=score;
+            }
+        }
+        return best;
+    }
+    // 记录一次运行的结果
+    void Bandit::observe(size_t index,Outcome outcome,double cost){
+        Arm &arm=_arms.at(index);
+        arm.pulls++;
+        arm.cost+=std::max(0.0,cost);
+        if(outcome==Outcome_Failure){
+            arm.failures++;
+        }
+        else if(outcome==Outcome_Duplicate){
+            arm.duplicates++;
+        }
+        else if(outcome==Outcome_Rejected){
+            arm.rejected++;
+        }
+    }
+    // 导出统计
+    json Bandit::state() const{
+        json arms=json::object();
+        for(const auto &arm:_arms){
+            arms[arm.name]={
+                { "pulls",arm.pulls },
+                { "failures",arm.failures },
+                { "duplicates",arm.duplicates },
+                { "rejected",arm.rejected },
+                { "cost",arm.cost }
+            };
+        }
+        return arms;
+    }
+    // 按名称读取统计
+    void Bandit::load(const json &state){
+        if(!state.is_object()){
+            return;
+        }
+        for(auto &arm:_arms){
+            if(!state.contains(arm.name)){
+                continue;
+            }
+            const json &item=state[arm.name];
+            arm.pulls=item.value("pulls",0.0);
+            arm.failures=item.value("failures",0.0);
+            arm.duplicates=item.value("duplicates",0.0);
+            arm.rejected=item.value("rejected",0.0);
+            arm.cost=item.value("cost",0.0);
+        }
+    }
+}
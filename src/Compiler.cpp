@@ -0,0 +1,280 @@
+#include "Compiler.h"
+#include "Hash.h"
+#include "Process.h"
+#include <fstream>
+#include <sstream>
+#include <regex>
+#include <algorithm>
+#include <atomic>
+#include <unistd.h>
+
+namespace acm{
+    // 临时文件名,同一进程中多个线程编译同一份源文件时互不覆盖
+    static string temp_suffix(){
+        static std::atomic<uint64_t> counter{ 0 };
+        return ".tmp"+std::to_string(getpid())+"_"+std::to_string(counter++);
+    }
+    // 构造函数
+    Compiler::Compiler(){}
+    // 设置编译器
+    void Compiler::set_compiler(const fs::path &compiler){
+        _compiler=compiler;
+        _version.clear();
+    }
+    // 设置缓存文件夹
+    void Compiler::set_cache(const fs::path &dir){
+        _cacheDir=dir;
+        if(!_cacheDir.empty()&&!fs::exists(_cacheDir)){
+            fs::create_directories(_cacheDir);
+        }
+    }
+    // 设置缓存大小上限
+    void Compiler::set_limit(uint64_t bytes){
+        _limit=bytes;
+    }
+    // 设置同时运行的编译器数量
+    void Compiler::set_jobs(int jobs){
+        std::lock_guard<std::mutex> lock(_mutex);
+        _jobs=jobs>0?jobs:1;
+        _slot.notify_all();
+    }
+    // 获取编译槽位
+    void Compiler::acquire(){
+        std::unique_lock<std::mutex> lock(_mutex);
+        _slot.wait(lock,[this]{ return _running<_jobs; });
+        _running++;
+    }
+    // 释放编译槽位
+    void Compiler::release(){
+        std::lock_guard<std::mutex> lock(_mutex);
+        _running--;
+        _slot.notify_one();
+    }
+    // 运行编译器
+    process::Status Compiler::run(const process::Args &args,string &error){
+        acquire();
+        process::Process proc(_compiler.string(),args);
+        process::Status status;
+        try{
+            proc.start();
+            status=proc.wait();
+            error=proc.get_error();
+        }
+        catch(...){
+            release();
+            throw;
+        }
+        release();
+        return status;
+    }
+    // 获取编译器版本
+    const string &Compiler::version(){
+        std::lock_guard<std::mutex> lock(_mutex);
+        if(_version.empty()){
+            process::Args args(_compiler.filename().string());
+            args.add("--version");
+            process::Process proc(_compiler.string(),args);
+            proc.start();
+            proc.wait();
+            _version=proc.read();
+            // 编译器无法运行时使用路径区分
+            if(_version.empty()){
+                _version=_compiler.string();
+            }
+        }
+        return _version;
+    }
+    // 递归哈希本地头文件
+    uint64_t Compiler::hash_source(const fs::path &file,const std::vector<fs::path> &dirs,std::set<fs::path> &visited,uint64_t hash){
+        std::ifstream in(file,std::ios::binary);
+        if(!in.is_open()){
+            // 找不到的文件只记录名字
+            return hash_bytes(file.string(),hash);
+        }
+        std::stringstream buffer;
+        buffer<<in.rdbuf();
+        string content=buffer.str();
+        hash=hash_bytes(content,hash);
+        // 只追踪引号形式的本地头文件,系统头文件由编译器版本区分
+        static const std::regex include(R"re(^\s*#\s*include\s*"([^"]+)")re");
+        std::istringstream lines(content);
+        string line;
+        while(std::getline(lines,line)){
+            std::smatch match;
+            if(!std::regex_search(line,match,include)){
+                continue;
+            }
+            fs::path found;
+            std::vector<fs::path> search={ file.parent_path() };
+            search.insert(search.end(),dirs.begin(),dirs.end());
+            for(const auto &dir:search){
+                if(fs::exists(dir/match[1].str())){
+                    found=fs::weakly_canonical(dir/match[1].str());
+                    break;
+                }
+            }
+            if(found.empty()){
+                hash=hash_bytes(match[1].str(),hash);
+                continue;
+            }
+            if(visited.insert(found).second){
+                hash=hash_source(found,dirs,visited,hash);
+            }
+        }
+        return hash;
+    }
+    // 编译参数中的头文件目录
+    static std::vector<fs::path> include_dirs(const std::vector<string> &flags){
+        std::vector<fs::path> dirs;
+        for(size_t i=0; i<flags.size(); i++){
+            if(flags[i]=="-I"&&i+1<flags.size()){
+                dirs.push_back(flags[i+1]);
+            }
+            else if(flags[i].compare(0,2,"-I")==0&&flags[i].size()>2){
+                dirs.push_back(flags[i].substr(2));
+            }
+        }
+        return dirs;
+    }
+    // 计算缓存键
+    uint64_t Compiler::key(const fs::path &src,const std::vector<string> &flags){
+        std::set<fs::path> visited;
+        uint64_t hash=hash_bytes(version());
+        for(const auto &flag:flags){
+            hash=hash_bytes(flag+'\0',hash);
+        }
+        return hash_source(src,include_dirs(flags),visited,hash);
+    }
+    // 源文件键
+    uint64_t Compiler::source_key(const fs::path &src,const std::vector<string> &flags){
+        std::set<fs::path> visited;
+        return hash_source(src,include_dirs(flags),visited,hash_bytes(""));
+    }
+    // 复制或硬链接到目标
+    bool Compiler::place(const fs::path &from,const fs::path &to){
+        std::error_code ec;
+        fs::remove(to,ec);
+        fs::create_hard_link(from,to,ec);
+        if(ec){
+            // 跨文件系统时复制
+            ec.clear();
+            fs::copy_file(from,to,fs::copy_options::overwrite_existing,ec);
+        }
+        return !ec;
+    }
+    // 编译源文件到目标
+    CompileResult Compiler::compile(const fs::path &src,const fs::path &target,const std::vector<string> &flags){
+        CompileResult result;
+        fs::path output=target;
+        fs::path entry;
+        if(!_cacheDir.empty()){
+            result.key=key(src,flags);
+            entry=_cacheDir/(to_hex(result.key)+".bin");
+            if(fs::exists(entry)){
+                // 更新使用时间
+                std::error_code ec;
+                fs::last_write_time(entry,fs::file_time_type::clock::now(),ec);
+                if(place(entry,target)){
+                    result.ok=true;
+                    result.hit=true;
+                    return result;
+                }
+            }
+            // 先写入临时文件再改名,多个进程同时编译时不会读到半个文件
+            output=_cacheDir/(to_hex(result.key)+temp_suffix());
+        }
+        process::Args args(_compiler.filename().string());
+        args.add(src.string()).add(flags).add("-o").add(output.string());
+        if(run(args,result.error)!=process::STOP){
+            std::error_code ec;
+            fs::remove(output,ec);
+            return result;
+        }
+        if(!_cacheDir.empty()){
+            std::error_code ec;
+            fs::rename(output,entry,ec);
+            if(ec){
+                fs::remove(output,ec);
+            }
+            if(!place(entry,target)){
+                result.error="无法写入目标文件: "+target.string();
+                return result;
+            }
+            evict();
+        }
+        result.ok=true;
+        return result;
+    }
+    // 预编译头文件
+    std::vector<string> Compiler::precompile(const fs::path &header,const std::vector<string> &flags){
+        if(_cacheDir.empty()||!fs::exists(header)){
+            return {};
+        }
+        uint64_t hash=hash_bytes(version());
+        for(const auto &flag:flags){
+            hash=hash_bytes(flag+'\0',hash);
+        }
+        hash=hash_file(header,hash);
+        fs::path name=header.filename();
+        fs::path dir=_cacheDir/"pch"/to_hex(hash);
+        std::lock_guard<std::mutex> lock(_pchMutex);
+        // 头文件和gch放在同一文件夹, -include 该头文件时g++自动使用gch
+        std::vector<string> use={ "-include",(dir/name).string() };
+        if(fs::exists(dir/(name.string()+".gch"))){
+            return use;
+        }
+        fs::path temp=dir.string()+temp_suffix();
+        std::error_code ec;
+        fs::remove_all(temp,ec);
+        fs::create_directories(temp);
+        fs::copy_file(header,temp/name);
+        process::Args args(_compiler.filename().string());
+        args.add(flags).add("-x").add("c++-header").add((temp/name).string()).add("-o").add((temp/(name.string()+".gch")).string());
+        string error;
+        if(run(args,error)!=process::STOP){
+            fs::remove_all(temp,ec);
+            return {};
+        }
+        // 其他进程已经构建完成时丢弃自己的结果
+        fs::rename(temp,dir,ec);
+        if(ec){
+            fs::remove_all(temp,ec);
+        }
+        return fs::exists(dir/(name.string()+".gch"))?use:std::vector<string>{};
+    }
+    // 按最近使用时间淘汰缓存
+    void Compiler::evict(){
+        if(_cacheDir.empty()||!fs::exists(_cacheDir)){
+            return;
+        }
+        struct Entry{
+            fs::path path;
+            fs::file_time_type time;
+            uint64_t size;
+        };
+        std::vector<Entry> entries;
+        uint64_t total=0;
+        std::error_code ec;
+        for(const auto &file:fs::directory_iterator(_cacheDir,ec)){
+            if(!file.is_regular_file()||file.path().extension()!=".bin"){
+                continue;
+            }
+            Entry temp{ file.path(),file.last_write_time(ec),file.file_size(ec) };
+            total+=temp.size;
+            entries.push_back(temp);
+        }
+        if(total<=_limit){
+            return;
+        }
+        std::sort(entries.begin(),entries.end(),[](const Entry &a,const Entry &b){
+            return a.time<b.time;
+        });
+        for(const auto &temp:entries){
+            if(total<=_limit){
+                break;
+            }
+            fs::remove(temp.path,ec);
+            total-=temp.size;
+        }
+    }
+}
@@ -0,0 +1,292 @@
+#include "Corpus.h"
+#include <fstream>
+#include <cstring>
+#include <algorithm>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace acm{
+    // 数据文件后缀
+    static const char *slot_ext(CorpusSlot slot){
+        return slot==Slot_In?".in":".out";
+    }
+    // 构造函数
+    Corpus::Corpus(){}
+    // 段文件路径
+    fs::path Corpus::segment_path(uint32_t segment) const{
+        string name=std::to_string(segment);
+        name=string(name.size()<5?5-name.size():0,'0')+name;
+        return _dir/("seg"+name+".dat");
+    }
+    // 打开追加段
+    void Corpus::open_segment(uint32_t segment){
+        if(_segFd!=-1){
+            ::close(_segFd);
+        }
+        _segment=segment;
+        _segFd=::open(segment_path(segment).c_str(),O_WRONLY|O_CREAT|O_APPEND|O_CLOEXEC,0644);
+        if(_segFd==-1){
+            throw std::runtime_error("Corpus: 无法打开段文件: "+segment_path(segment).string()+" - "+strerror(errno));
+        }
+        struct stat st;
+        _segSize=(::fstat(_segFd,&st)==0)?st.st_size:0;
+    }
+    // 打开语料库
+    void Corpus::open(const fs::path &dir){
+        close();
+        _dir=dir;
+        if(!fs::exists(_dir)){
+            fs::create_directories(_dir);
+        }
+        _indexFd=::open((_dir/"index.dat").c_str(),O_RDWR|O_CREAT|O_CLOEXEC,0644);
+        if(_indexFd==-1){
+            throw std::runtime_error("Corpus: 无法打开索引: "+(_dir/"index.dat").string()+" - "+strerror(errno));
+        }
+        // 找到最后一个段继续追加
+        uint32_t last=0;
+        for(const auto &entry:fs::directory_iterator(_dir)){
+            string name=entry.path().filename().string();
+            if(name.size()==12&&name.compare(0,3,"seg")==0&&entry.path().extension()==".dat"){
+                last=std::max(last,(uint32_t)std::stoul(name.substr(3,5)));
+            }
+        }
+        open_segment(last);
+    }
+    // 文件夹是否为语料库
+    bool Corpus::exists(const fs::path &dir){
+        return fs::exists(dir/"index.dat");
+    }
+    // 是否已经打开
+    bool Corpus::is_open() const{
+        return _indexFd!=-1;
+    }
+    // 设置单个段的大小上限
+    void Corpus::set_segment_limit(uint64_t bytes){
+        _segLimit=bytes;
+    }
+    // 索引中的最大编号
+    size_t Corpus::size() const{
+        struct stat st;
+        if(_indexFd==-1||::fstat(_indexFd,&st)!=0){
+            return 0;
+        }
+        return st.st_size/sizeof(CorpusRecord);
+    }
+    // 读取索引记录
+    CorpusRecord Corpus::record(size_t id) const{
+        CorpusRecord record;
+        std::memset(&record,0,sizeof(record));
+        record.mode=-1;
+        record.verdict=-1;
+        if(id==0||_indexFd==-1){
+            return record;
+        }
+        CorpusRecord temp;
+        ssize_t n=::pread(_indexFd,&temp,sizeof(temp),(off_t)(id-1)*sizeof(CorpusRecord));
+        if(n==(ssize_t)sizeof(temp)&&(temp.flags&Record_Used)){
+            record=temp;
+        }
+        return record;
+    }
+    // 写入索引记录
+    void Corpus::write_record(size_t id,const CorpusRecord &record){
+        if(id==0){
+            throw std::invalid_argument("Corpus: 编号必须从1开始");
+        }
+        ssize_t n=::pwrite(_indexFd,&record,sizeof(record),(off_t)(id-1)*sizeof(CorpusRecord));
+        if(n!=(ssize_t)sizeof(record)){
+            throw std::runtime_error("Corpus: 写入索引失败: "+_dir.string());
+        }
+    }
+    // 更新索引记录的元数据
+    void Corpus::set_record(size_t id,const CorpusRecord &record){
+        CorpusRecord temp=record;
+        // 数据位置只能由put写入
+        CorpusRecord old=this->record(id);
+        std::memcpy(temp.slot,old.slot,sizeof(temp.slot));
+        temp.flags|=Record_Used;
+        write_record(id,temp);
+    }
+    // 是否存在数据
+    bool Corpus::has(size_t id,CorpusSlot slot) const{
+        return record(id).slot[slot].flags!=0;
+    }
+    // 追加数据到段
+    CorpusRecord::Slot Corpus::append(const char *data,size_t size){
+        if(_segFd==-1){
+            throw std::runtime_error("Corpus: 语料库未打开");
+        }
+        // 当前段已满则切换到新段
+        if(_segSize>0&&_segSize+size>_segLimit){
+            open_segment(_segment+1);
+        }
+        CorpusRecord::Slot slot{ _segment,1,_segSize,size };
+        size_t left=size;
+        while(left>0){
+            ssize_t n=::write(_segFd,data,left);
+            if(n<0){
+                if(errno==EINTR) continue;
+                throw std::runtime_error("Corpus: 写入段文件失败: "+segment_path(_segment).string()+" - "+strerror(errno));
+            }
+            data+=n;
+            left-=n;
+        }
+        _segSize+=size;
+        return slot;
+    }
+    // 写入数据
+    void Corpus::put(size_t id,CorpusSlot slot,std::string_view data){
+        // 先写数据再写索引,中断时索引不会指向未写入的数据
+        CorpusRecord::Slot pos=append(data.data(),data.size());
+        CorpusRecord record=this->record(id);
+        record.slot[slot]=pos;
+        record.flags|=Record_Used;
+        write_record(id,record);
+    }
+    // 从文件写入数据
+    void Corpus::put_file(size_t id,CorpusSlot slot,const fs::path &file){
+        std::ifstream in(file,std::ios::binary);
+        if(!in.is_open()){
+            throw std::runtime_error("Corpus: 无法打开文件: "+file.string());
+        }
+        string content((std::istreambuf_iterator<char>(in)),std::istreambuf_iterator<char>());
+        put(id,slot,content);
+    }
+    // 丢弃数据
+    void Corpus::drop(size_t id,CorpusSlot slot){
+        CorpusRecord record=this->record(id);
+        if(!(record.flags&Record_Used)||record.slot[slot].flags==0){
+            return;
+        }
+        std::memset(&record.slot[slot],0,sizeof(record.slot[slot]));
+        write_record(id,record);
+    }
+    // 映射段文件
+    const char *Corpus::map(uint32_t segment,uint64_t end){
+        if(segment>=_maps.size()){
+            _maps.resize(segment+1);
+        }
+        Map &m=_maps[segment];
+        if(m.size>=end&&m.addr!=nullptr){
+            return static_cast<const char *>(m.addr);
+        }
+        if(m.fd==-1){
+            m.fd=::open(segment_path(segment).c_str(),O_RDONLY|O_CLOEXEC);
+            if(m.fd==-1){
+                throw std::runtime_error("Corpus: 无法打开段文件: "+segment_path(segment).string());
+            }
+        }
+        // 段文件增长后重新映射
+        if(m.addr!=nullptr){
+            ::munmap(m.addr,m.size);
+            m.addr=nullptr;
+            m.size=0;
+        }
+        struct stat st;
+        if(::fstat(m.fd,&st)!=0||(uint64_t)st.st_size<end){
+            throw std::runtime_error("Corpus: 段文件损坏: "+segment_path(segment).string());
+        }
+        void *addr=::mmap(nullptr,st.st_size,PROT_READ,MAP_SHARED,m.fd,0);
+        if(addr==MAP_FAILED){
+            throw std::runtime_error("Corpus: 映射段文件失败: "+segment_path(segment).string());
+        }
+        m.addr=addr;
+        m.size=st.st_size;
+        return static_cast<const char *>(m.addr);
+    }
+    // 读取数据
+    std::string_view Corpus::get(size_t id,CorpusSlot slot){
+        CorpusRecord::Slot pos=record(id).slot[slot];
+        if(pos.flags==0||pos.length==0){
+            return std::string_view();
+        }
+        const char *base=map(pos.segment,pos.offset+pos.length);
+        return std::string_view(base+pos.offset,pos.length);
+    }
+    // 读取数据到文件
+    bool Corpus::get_file(size_t id,CorpusSlot slot,const fs::path &file){
+        if(!has(id,slot)){
+            return false;
+        }
+        std::string_view data=get(id,slot);
+        std::ofstream out(file,std::ios::binary|std::ios::trunc);
+        if(!out.is_open()){
+            throw std::runtime_error("Corpus: 无法打开文件: "+file.string());
+        }
+        out.write(data.data(),data.size());
+        return true;
+    }
+    // 导出为松散文件
+    size_t Corpus::export_to(const std::vector<fs::path> &dirs){
+        if(dirs.size()<Slot_Num){
+            throw std::invalid_argument("Corpus: 导出需要三个文件夹");
+        }
+        for(const auto &dir:dirs){
+            fs::create_directories(dir);
+        }
+        size_t count=0;
+        for(size_t id=1; id<=size(); id++){
+            bool any=false;
+            for(int slot=Slot_In; slot<Slot_Num; slot++){
+                CorpusSlot s=static_cast<CorpusSlot>(slot);
+                any|=get_file(id,s,dirs[slot]/("data"+std::to_string(id)+slot_ext(s)));
+            }
+            count+=any;
+        }
+        return count;
+    }
+    // 从松散文件导入
+    size_t Corpus::import_from(const std::vector<fs::path> &dirs){
+        if(dirs.size()<Slot_Num||!fs::exists(dirs[Slot_In])){
+            return 0;
+        }
+        size_t count=0;
+        for(const auto &entry:fs::directory_iterator(dirs[Slot_In])){
+            string name=entry.path().stem().string();
+            if(entry.path().extension()!=".in"||name.compare(0,4,"data")!=0){
+                continue;
+            }
+            string digits=name.substr(4);
+            if(digits.empty()||!std::all_of(digits.begin(),digits.end(),::isdigit)){
+                continue;
+            }
+            size_t id=std::stoul(digits);
+            for(int slot=Slot_In; slot<Slot_Num; slot++){
+                CorpusSlot s=static_cast<CorpusSlot>(slot);
+                fs::path file=dirs[slot]/(name+slot_ext(s));
+                if(fs::exists(file)){
+                    put_file(id,s,file);
+                }
+            }
+            count++;
+        }
+        return count;
+    }
+    // 关闭
+    void Corpus::close(){
+        for(auto &m:_maps){
+            if(m.addr!=nullptr){
+                ::munmap(m.addr,m.size);
+            }
+            if(m.fd!=-1){
+                ::close(m.fd);
+            }
+        }
+        _maps.clear();
+        if(_segFd!=-1){
+            ::close(_segFd);
+            _segFd=-1;
+        }
+        if(_indexFd!=-1){
+            ::close(_indexFd);
+            _indexFd=-1;
+        }
+    }
+    // 析构函数
+    Corpus::~Corpus(){
+        close();
+    }
+}
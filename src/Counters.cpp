@@ -0,0 +1,79 @@
+#include "Counters.h"
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cstring>
+#include <cstdint>
+
+namespace process{
+    // 计数器的类型和编号,与 CounterValues 的成员顺序一致
+    static const struct{
+        uint32_t type;
+        uint64_t config;
+    } CounterEvents[]={
+        { PERF_TYPE_HARDWARE,PERF_COUNT_HW_INSTRUCTIONS },
+        { PERF_TYPE_HARDWARE,PERF_COUNT_HW_CPU_CYCLES },
+        { PERF_TYPE_HARDWARE,PERF_COUNT_HW_CACHE_MISSES },
+        { PERF_TYPE_HARDWARE,PERF_COUNT_HW_BRANCH_MISSES },
+        { PERF_TYPE_SOFTWARE,PERF_COUNT_SW_PAGE_FAULTS }
+    };
+    // 是否有可用的计数
+    bool CounterValues::any() const{
+        return instructions>=0||cycles>=0||cacheMisses>=0||branchMisses>=0||pageFaults>=0;
+    }
+    // 构造函数
+    Counters::Counters(){
+        for(int &fd:_fds){
+            fd=-1;
+        }
+    }
+    // 为进程打开计数器
+    bool Counters::open(pid_t pid){
+        close();
+        bool opened=false;
+        for(int i=0; i<Counter_Num; i++){
+            perf_event_attr attr;
+            std::memset(&attr,0,sizeof(attr));
+            attr.size=sizeof(attr);
+            attr.type=CounterEvents[i].type;
+            attr.config=CounterEvents[i].config;
+            attr.disabled=1;
+            attr.enable_on_exec=1;
+            attr.inherit=1;
+            // perf_event_paranoid 为2时只允许用户态计数
+            attr.exclude_kernel=1;
+            attr.exclude_hv=1;
+            _fds[i]=syscall(SYS_perf_event_open,&attr,pid,-1,-1,PERF_FLAG_FD_CLOEXEC);
+            opened|=_fds[i]!=-1;
+        }
+        return opened;
+    }
+    // 读取计数
+    CounterValues Counters::read() const{
+        long long values[Counter_Num];
+        for(int i=0; i<Counter_Num; i++){
+            uint64_t value=0;
+            values[i]=_fds[i]!=-1&&::read(_fds[i],&value,sizeof(value))==sizeof(value)?(long long)value:-1;
+        }
+        CounterValues res;
+        res.instructions=values[0];
+        res.cycles=values[1];
+        res.cacheMisses=values[2];
+        res.branchMisses=values[3];
+        res.pageFaults=values[4];
+        return res;
+    }
+    // 关闭计数器
+    void Counters::close(){
+        for(int &fd:_fds){
+            if(fd!=-1){
+                ::close(fd);
+                fd=-1;
+            }
+        }
+    }
+    // 析构函数
+    Counters::~Counters(){
+        close();
+    }
+}
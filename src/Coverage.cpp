@@ -0,0 +1,149 @@
+#include "Coverage.h"
+#include <fstream>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <sys/mman.h>
+
+namespace acm{
+    // 创建并映射位图文件
+    void CoverageMap::open(const fs::path &file){
+        close();
+        int fd=::open(file.c_str(),O_RDWR|O_CREAT|O_CLOEXEC,0644);
+        if(fd==-1){
+            throw std::runtime_error("CoverageMap: 无法打开位图文件: "+file.string()+" - "+strerror(errno));
+        }
+        if(::ftruncate(fd,CoverageSize)!=0){
+            ::close(fd);
+            throw std::runtime_error("CoverageMap: 无法设置位图大小: "+file.string());
+        }
+        void *addr=::mmap(nullptr,CoverageSize,PROT_READ|PROT_WRITE,MAP_SHARED,fd,0);
+        ::close(fd);
+        if(addr==MAP_FAILED){
+            throw std::runtime_error("CoverageMap: 映射位图失败: "+file.string());
+        }
+        _file=file;
+        _data=static_cast<uint8_t *>(addr);
+    }
+    // 清空位图
+    void CoverageMap::clear(){
+        if(_data!=nullptr){
+            std::memset(_data,0,CoverageSize);
+        }
+    }
+    // 位图数据
+    const uint8_t *CoverageMap::data() const{
+        return _data;
+    }
+    // 位图文件路径
+    const fs::path &CoverageMap::path() const{
+        return _file;
+    }
+    // 解除映射
+    void CoverageMap::close(){
+        if(_data!=nullptr){
+            ::munmap(_data,CoverageSize);
+            _data=nullptr;
+        }
+    }
+    // 析构函数
+    CoverageMap::~CoverageMap(){
+        close();
+    }
+    // 构造函数
+    Coverage::Coverage():_seen(CoverageSize,0){}
+    // 命中次数分桶: 1 2 3 4-7 8-15 16-31 32-127 128+
+    uint8_t Coverage::bucket(uint8_t hits){
+        if(hits==0) return 0;
+        if(hits==1) return 1;
+        if(hits==2) return 2;
+        if(hits==3) return 4;
+        if(hits<8) return 8;
+        if(hits<16) return 16;
+        if(hits<32) return 32;
+        if(hits<128) return 64;
+        return 128;
+    }
+    // 一次运行带来的新覆盖数量
+    size_t Coverage::novelty(const uint8_t *trace) const{
+        size_t count=0;
+        for(size_t i=0; i<CoverageSize; i++){
+            count+=(bucket(trace[i])&~_seen[i])!=0;
+        }
+        return count;
+    }
+    // 合并一次运行的位图
+    size_t Coverage::merge(const uint8_t *trace){
+        size_t count=0;
+        for(size_t i=0; i<CoverageSize; i++){
+            uint8_t b=bucket(trace[i]);
+            if(b&~_seen[i]){
+                _seen[i]|=b;
+                count++;
+            }
+        }
+        return count;
+    }
+    // 已经覆盖的边数量
+    size_t Coverage::edges() const{
+        size_t count=0;
+        for(uint8_t b:_seen){
+            count+=b!=0;
+        }
+        return count;
+    }
+    // 读取累计覆盖率
+    bool Coverage::load(const fs::path &file){
+        std::ifstream in(file,std::ios::binary);
+        if(!in.is_open()){
+            return false;
+        }
+        std::vector<uint8_t> temp(CoverageSize);
+        in.read(reinterpret_cast<char *>(temp.data()),temp.size());
+        if((size_t)in.gcount()!=CoverageSize||in.peek()!=EOF){
+            return false;
+        }
+        _seen.swap(temp);
+        return true;
+    }
+    // 保存累计覆盖率
+    void Coverage::save(const fs::path &file) const{
+        std::ofstream out(file,std::ios::binary|std::ios::trunc);
+        if(!out.is_open()){
+            throw std::runtime_error("Coverage: 无法写入文件: "+file.string());
+        }
+        out.write(reinterpret_cast<const char *>(_seen.data()),_seen.size());
+    }
+    // 运行时桩代码
+    string Coverage::runtime(){
+        // 位置取相对可执行文件起始地址的偏移,不受地址随机化影响
+        // 边为 上一个位置/2 异或 当前位置,与 AFL 相同
+        return R"rt(// AutoTestlib 覆盖率运行时,由 -fsanitize-coverage=trace-pc 调用
+#include <cstdint>
+#include <cstdlib>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+extern "C" char __executable_start;
+static unsigned char acm_cov_dummy[1<<16];
+static unsigned char *acm_cov_map=acm_cov_dummy;
+static uintptr_t acm_cov_prev=0;
+__attribute__((constructor(101),no_sanitize_coverage)) static void acm_cov_init(){
+    const char *path=getenv("ACM_COVERAGE");
+    if(path==nullptr) return;
+    int fd=open(path,O_RDWR|O_CLOEXEC);
+    if(fd<0) return;
+    void *addr=mmap(nullptr,1<<16,PROT_READ|PROT_WRITE,MAP_SHARED,fd,0);
+    close(fd);
+    if(addr!=MAP_FAILED) acm_cov_map=static_cast<unsigned char *>(addr);
+}
+extern "C" __attribute__((no_sanitize_coverage)) void __sanitizer_cov_trace_pc(){
+    uintptr_t loc=(uintptr_t)__builtin_return_address(0)-(uintptr_t)&__executable_start;
+    loc=(uint64_t)(loc*0x9E3779B97F4A7C15ull)>>48;
+    acm_cov_map[(loc^acm_cov_prev)&0xffff]++;
+    acm_cov_prev=loc>>1;
+}
+)rt";
+    }
+}
@@ -0,0 +1,132 @@
+#include "Diagnosis.h"
+#include <sstream>
+#include <cstdlib>
+#include <unistd.h>
+
+namespace acm{
+    // 消毒器编译选项
+    std::vector<string> Diagnosis::sanitizer_flags(){
+        // 未定义行为第一次出现就终止,保证报告的是第一个错误
+        return { "-fsanitize=address,undefined","-fno-sanitize-recover=all","-fno-omit-frame-pointer","-g" };
+    }
+    // 消毒器运行时的环境变量
+    std::map<string,string> Diagnosis::sanitizer_env(){
+        return {
+            { "ASAN_OPTIONS","detect_leaks=0:abort_on_error=0:symbolize=1" },
+            { "UBSAN_OPTIONS","print_stacktrace=1:halt_on_error=1:symbolize=1" }
+        };
+    }
+    // 提取第一个错误和调用栈
+    string Diagnosis::sanitizer_report(const string &output,size_t frames){
+        // 去掉 ASan 行首的 ==pid== 前缀
+        auto strip=[](const string &line){
+            if(line.compare(0,2,"==")==0){
+                size_t end=line.find("==",2);
+                if(end!=string::npos){
+                    return line.substr(end+2);
+                }
+            }
+            return line;
+            };
+        auto is_frame=[](const string &line){
+            size_t pos=line.find_first_not_of(" \t");
+            return pos!=string::npos&&pos>0&&line[pos]=='#';
+            };
+        std::istringstream stream(output);
+        string line,report,summary;
+        bool found=false,stack=false,done=false;
+        size_t count=0;
+        while(std::getline(stream,line)){
+            if(!found){
+                if(line.find("ERROR: AddressSanitizer")!=string::npos||line.find("ERROR: UndefinedBehaviorSanitizer")!=string::npos||
+                    line.find("ERROR: LeakSanitizer")!=string::npos||line.find("runtime error:")!=string::npos){
+                    found=true;
+                    report=strip(line)+"\n";
+                }
+                continue;
+            }
+            if(line.compare(0,8,"SUMMARY:")==0){
+                summary=line+"\n";
+                break;
+            }
+            // 只保留第一个调用栈,之后只继续寻找总结行
+            if(is_frame(line)){
+                if(done){
+                    continue;
+                }
+                stack=true;
+                if(count++<frames){
+                    report+=line+"\n";
+                }
+            }
+            else if(stack){
+                done=true;
+            }
+            else if(!line.empty()){
+                report+=strip(line)+"\n";
+            }
+        }
+        if(!found){
+            return "";
+        }
+        if(count>frames){
+            report+="    ... "+std::to_string(count-frames)+" 帧省略\n";
+        }
+        return report+summary;
+    }
+    // 提取 massif 的峰值快照
+    string Diagnosis::massif_report(const string &content,size_t lines){
+        std::istringstream stream(content);
+        string line,heap,extra,stacks,report;
+        bool peak=false;
+        size_t count=0;
+        while(std::getline(stream,line)){
+            if(!peak){
+                // 每个快照开头重置字节数
+                if(line.compare(0,9,"snapshot=")==0){
+                    heap=extra=stacks="";
+                }
+                else if(line.compare(0,11,"mem_heap_B=")==0){
+                    heap=line.substr(11);
+                }
+                else if(line.compare(0,17,"mem_heap_extra_B=")==0){
+                    extra=line.substr(17);
+                }
+                else if(line.compare(0,13,"mem_stacks_B=")==0){
+                    stacks=line.substr(13);
+                }
+                else if(line=="heap_tree=peak"){
+                    peak=true;
+                    report="峰值堆内存 "+heap+" 字节,额外开销 "+extra+" 字节,栈 "+stacks+" 字节\n";
+                }
+                continue;
+            }
+            if(line.compare(0,9,"snapshot=")==0||line.compare(0,1,"#")==0){
+                break;
+            }
+            if(count++<lines){
+                report+=line+"\n";
+            }
+        }
+        return report;
+    }
+    // 在 PATH 中查找程序
+    fs::path Diagnosis::which(const string &name){
+        const char *path=std::getenv("PATH");
+        if(path==nullptr){
+            return {};
+        }
+        std::istringstream stream(path);
+        string dir;
+        while(std::getline(stream,dir,':')){
+            if(dir.empty()){
+                continue;
+            }
+            fs::path file=fs::path(dir)/name;
+            if(::access(file.c_str(),X_OK)==0){
+                return file;
+            }
+        }
+        return {};
+    }
+}
@@ -0,0 +1,37 @@
+#include "Hash.h"
+#include <fstream>
+
+namespace acm{
+    // FNV-1a 64位哈希
+    uint64_t hash_bytes(std::string_view data,uint64_t seed){
+        uint64_t hash=seed;
+        for(unsigned char c:data){
+            hash^=c;
+            hash*=0x100000001b3ull;
+        }
+        return hash;
+    }
+    // 文件内容哈希
+    uint64_t hash_file(const fs::path &file,uint64_t seed){
+        std::ifstream in(file,std::ios::binary);
+        if(!in.is_open()){
+            return 0;
+        }
+        uint64_t hash=seed;
+        char buffer[65536];
+        while(in.read(buffer,sizeof(buffer))||in.gcount()>0){
+            hash=hash_bytes(std::string_view(buffer,in.gcount()),hash);
+        }
+        return hash;
+    }
+    // 转换为十六进制字符串
+    string to_hex(uint64_t value){
+        static const char digits[]="0123456789abcdef";
+        string result(16,'0');
+        for(int i=15; i>=0; i--){
+            result[i]=digits[value&0xf];
+            value>>=4;
+        }
+        return result;
+    }
+}
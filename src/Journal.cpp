@@ -0,0 +1,120 @@
+#include "Journal.h"
+#include <fstream>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+
+namespace acm{
+    // 构造函数
+    Journal::Journal(){}
+    Journal::Journal(const fs::path &file){
+        set_path(file);
+    }
+    // 打开日志文件
+    void Journal::open(){
+        if(_fd!=-1){
+            ::close(_fd);
+        }
+        _fd=::open(_filePath.c_str(),O_WRONLY|O_CREAT|O_APPEND|O_CLOEXEC,0644);
+        if(_fd==-1){
+            throw std::runtime_error("Journal: 无法打开文件: "+_filePath.string()+" - "+strerror(errno));
+        }
+    }
+    // 设置路径
+    void Journal::set_path(const fs::path &file){
+        _filePath=file;
+        _entries=0;
+        if(!_filePath.parent_path().empty()&&!fs::exists(_filePath.parent_path())){
+            fs::create_directories(_filePath.parent_path());
+        }
+        open();
+    }
+    // 设置压缩阈值
+    void Journal::set_compact(size_t limit){
+        _compactLimit=limit;
+    }
+    // 追加一条记录
+    void Journal::append(const json &entry){
+        if(_fd==-1){
+            throw std::runtime_error("Journal: 日志文件未打开");
+        }
+        // 一条记录一次write,进程被杀时最多留下一行残缺记录
+        string line=entry.dump()+"\n";
+        const char *data=line.data();
+        size_t left=line.size();
+        while(left>0){
+            ssize_t n=::write(_fd,data,left);
+            if(n<0){
+                if(errno==EINTR) continue;
+                throw std::runtime_error("Journal: 写入失败: "+_filePath.string()+" - "+strerror(errno));
+            }
+            data+=n;
+            left-=n;
+        }
+        _entries++;
+    }
+    // 回放日志到数据中
+    size_t Journal::replay(json &data){
+        std::ifstream file(_filePath,std::ios::binary);
+        if(!file.is_open()){
+            return 0;
+        }
+        string content((std::istreambuf_iterator<char>(file)),std::istreambuf_iterator<char>());
+        file.close();
+        size_t count=0;
+        // 最后一条完整记录的结束位置
+        size_t good=0;
+        size_t pos=0;
+        while(pos<content.size()){
+            size_t end=content.find('\n',pos);
+            // 没有换行的尾部是被中断的写入
+            if(end==string::npos) break;
+            json entry;
+            try{
+                entry=json::parse(content.begin()+pos,content.begin()+end);
+            }
+            catch(const json::parse_error &e){
+                break;
+            }
+            if(entry.is_object()){
+                data.update(entry);
+                count++;
+            }
+            pos=end+1;
+            good=pos;
+        }
+        // 截掉残缺的尾部,避免后续追加接在坏数据后面
+        if(good<content.size()){
+            if(::truncate(_filePath.c_str(),good)==-1){
+                throw std::runtime_error("Journal: 无法截断文件: "+_filePath.string());
+            }
+        }
+        _entries=count;
+        return count;
+    }
+    // 是否需要压缩
+    bool Journal::need_compact() const{
+        return _entries>=_compactLimit;
+    }
+    // 清空日志
+    void Journal::clear(){
+        if(_fd==-1){
+            return;
+        }
+        if(::ftruncate(_fd,0)==-1){
+            throw std::runtime_error("Journal: 无法清空文件: "+_filePath.string());
+        }
+        _entries=0;
+    }
+    // 记录条数
+    size_t Journal::size() const{
+        return _entries;
+    }
+    // 析构函数
+    Journal::~Journal(){
+        if(_fd!=-1){
+            ::close(_fd);
+        }
+    }
+}
@@ -0,0 +1,186 @@
+#include "Mutator.h"
+#include <algorithm>
+
+namespace acm{
+    // 构造函数
+    Mutator::Mutator(uint64_t key):_rng(key){}
+    // 添加种子输入
+    void Mutator::add(const string &input){
+        Tokens tokens=split_tokens(input);
+        if(tokens.empty()){
+            return;
+        }
+        for(const auto &line:tokens){
+            for(const auto &token:line){
+                if(!is_integer(token)){
+                    continue;
+                }
+                long long value=std::stoll(token);
+                _min=_hasNumber?std::min(_min,value):value;
+                _max=_hasNumber?std::max(_max,value):value;
+                _hasNumber=true;
+            }
+        }
+        _corpus.push_back(tokens);
+    }
+    // 种子数量
+    size_t Mutator::size() const{
+        return _corpus.size();
+    }
+    // 把数量头加上 delta
+    bool Mutator::adjust_count(Tokens &tokens,size_t line,long long oldCount,long long delta){
+        auto fix=[&](string &token){
+            if(is_integer(token)&&std::stoll(token)==oldCount){
+                token=std::to_string(oldCount+delta);
+                return true;
+            }
+            return false;
+        };
+        if(line>0){
+            for(auto &token:tokens[line-1]){
+                if(fix(token)){
+                    return true;
+                }
+            }
+        }
+        // 同一行开头的数量头不计入数量
+        if(!tokens[line].empty()&&is_integer(tokens[line][0])&&std::stoll(tokens[line][0])==oldCount-1){
+            tokens[line][0]=std::to_string(oldCount-1+delta);
+            return true;
+        }
+        return false;
+    }
+    // 随机选择一个整数推向边界
+    bool Mutator::boundary(Tokens &tokens){
+        std::vector<std::pair<size_t,size_t>> numbers;
+        for(size_t i=0; i<tokens.size(); i++){
+            for(size_t j=0; j<tokens[i].size(); j++){
+                if(is_integer(tokens[i][j])){
+                    numbers.emplace_back(i,j);
+                }
+            }
+        }
+        if(numbers.empty()){
+            return false;
+        }
+        auto [line,index]=numbers[_rng.below(numbers.size())];
+        long long value=std::stoll(tokens[line][index]);
+        // 0、±1、相邻值、翻倍减半,以及语料中出现过的最小最大值和它们的外侧
+        std::vector<long long> values={ 0,1,-1,value+1,value-1,-value,value*2,value/2,_min,_max,_min-1,_max+1 };
+        values.erase(std::remove(values.begin(),values.end(),value),values.end());
+        tokens[line][index]=std::to_string(values[_rng.below(values.size())]);
+        return true;
+    }
+    // 交换同一行的两个元素
+    bool Mutator::swap_tokens(Tokens &tokens){
+        std::vector<size_t> lines;
+        for(size_t i=0; i<tokens.size(); i++){
+            if(tokens[i].size()>=2){
+                lines.push_back(i);
+            }
+        }
+        if(lines.empty()){
+            return false;
+        }
+        auto &line=tokens[lines[_rng.below(lines.size())]];
+        size_t a=_rng.below(line.size()),b=_rng.below(line.size());
+        if(a==b||line[a]==line[b]){
+            return false;
+        }
+        std::swap(line[a],line[b]);
+        return true;
+    }
+    // 复制一个元素
+    bool Mutator::duplicate_token(Tokens &tokens){
+        size_t line=_rng.below(tokens.size());
+        auto &row=tokens[line];
+        if(row.empty()){
+            return false;
+        }
+        long long count=row.size();
+        size_t index=_rng.below(row.size());
+        row.insert(row.begin()+index,row[index]);
+        if(_rng.below(2)){
+            adjust_count(tokens,line,count,1);
+        }
+        return true;
+    }
+    // 交换两行
+    bool Mutator::swap_lines(Tokens &tokens){
+        if(tokens.size()<3){
+            return false;
+        }
+        // 第一行通常是数量,不参与交换
+        size_t a=1+_rng.below(tokens.size()-1),b=1+_rng.below(tokens.size()-1);
+        if(a==b||tokens[a]==tokens[b]){
+            return false;
+        }
+        std::swap(tokens[a],tokens[b]);
+        return true;
+    }
+    // 复制一行
+    bool Mutator::duplicate_line(Tokens &tokens){
+        if(tokens.size()<2){
+            return false;
+        }
+        size_t line=1+_rng.below(tokens.size()-1);
+        tokens.insert(tokens.begin()+line,tokens[line]);
+        // 第一行只有一个数且等于后面的行数时同时修正
+        if(_rng.below(2)&&tokens[0].size()==1&&is_integer(tokens[0][0])&&
+            std::stoll(tokens[0][0])==(long long)tokens.size()-2){
+            tokens[0][0]=std::to_string(tokens.size()-1);
+        }
+        return true;
+    }
+    // 与另一个输入拼接
+    bool Mutator::splice(Tokens &tokens){
+        const Tokens &other=_corpus[_rng.below(_corpus.size())];
+        if(tokens.size()<2||other.size()<2){
+            return false;
+        }
+        size_t cut=1+_rng.below(tokens.size()-1);
+        size_t from=1+_rng.below(other.size()-1);
+        bool header=tokens[0].size()==1&&is_integer(tokens[0][0])&&
+            std::stoll(tokens[0][0])==(long long)tokens.size()-1;
+        tokens.resize(cut);
+        tokens.insert(tokens.end(),other.begin()+from,other.end());
+        if(header){
+            tokens[0][0]=std::to_string(tokens.size()-1);
+        }
+        return true;
+    }
+    // 生成一个变异
+    string Mutator::mutate(){
+        if(_corpus.empty()){
+            return "";
+        }
+        Tokens tokens=_corpus[_rng.below(_corpus.size())];
+        int steps=1+_rng.below(4);
+        // 不适用的操作换一个重试,避免死循环限制总次数
+        for(int tries=0; steps>0&&tries<32; tries++){
+            bool done=false;
+            switch(_rng.below(6)){
+            case 0:
+                done=boundary(tokens);
+                break;
+            case 1:
+                done=swap_tokens(tokens);
+                break;
+            case 2:
+                done=duplicate_token(tokens);
+                break;
+            case 3:
+                done=swap_lines(tokens);
+                break;
+            case 4:
+                done=duplicate_line(tokens);
+                break;
+            default:
+                done=splice(tokens);
+                break;
+            }
+            steps-=done;
+        }
+        return join_tokens(tokens);
+    }
+}
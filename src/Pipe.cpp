@@ -26,7 +26,8 @@ namespace process{
     }
     // 创建管道
     void Pipe::create(){
-        if(::pipe(_pipe)==-1){
+        // 多线程同时创建子进程时,避免管道被其他子进程继承
+        if(::pipe2(_pipe,O_CLOEXEC)==-1){
             throw std::runtime_error("Failed to create pipe");
         }
         _pipeType=true;
@@ -41,12 +42,15 @@ namespace process{
     }
     // 关闭管道
     void Pipe::close(){
+        // 关闭后置为-1,避免多线程时关闭其他线程复用的同号描述符
         if(!is_closed(PIPE_READ)){
             ::close(_pipe[PIPE_READ]);
         }
+        _pipe[PIPE_READ]=-1;
         if(!is_closed(PIPE_WRITE)){
             ::close(_pipe[PIPE_WRITE]);
         }
+        _pipe[PIPE_WRITE]=-1;
     }
     // 设置阻塞模式
     void Pipe::set_blocked(bool isblocked){
@@ -88,6 +92,7 @@ namespace process{
         if(autoClose){
             // 关闭另一个管道
             ::close(_pipe[!_pipeType]);
+            _pipe[!_pipeType]=-1;
         }
     }
     // 设置缓冲区大小
@@ -0,0 +1,205 @@
+#include "Placement.h"
+#include <fstream>
+#include <map>
+#include <algorithm>
+#include <sched.h>
+
+namespace acm{
+    // 解析CPU列表
+    std::vector<int> Placement::parse_list(const string &list){
+        std::vector<int> cpus;
+        size_t pos=0;
+        while(pos<list.size()){
+            size_t end=list.find(',',pos);
+            if(end==string::npos){
+                end=list.size();
+            }
+            string item=list.substr(pos,end-pos);
+            pos=end+1;
+            if(item.find_first_not_of(" \n\t")==string::npos){
+                continue;
+            }
+            size_t dash=item.find('-');
+            try{
+                int low=std::stoi(item.substr(0,dash));
+                int high=dash==string::npos?low:std::stoi(item.substr(dash+1));
+                for(int cpu=low; cpu<=high; cpu++){
+                    cpus.push_back(cpu);
+                }
+            }
+            catch(const std::exception &e){
+                throw std::runtime_error("Placement: CPU列表格式错误: "+list);
+            }
+        }
+        return cpus;
+    }
+    // 读取SMT拓扑
+    std::vector<std::vector<int>> Placement::topology(const std::vector<int> &allowed,const fs::path &sysfs){
+        std::map<string,std::vector<int>> groups;
+        std::vector<std::vector<int>> cores;
+        for(int cpu:allowed){
+            std::ifstream file(sysfs/("cpu"+std::to_string(cpu))/"topology"/"thread_siblings_list");
+            string siblings;
+            if(!std::getline(file,siblings)||siblings.empty()){
+                siblings="cpu"+std::to_string(cpu);
+            }
+            groups[siblings].push_back(cpu);
+        }
+        for(auto &[siblings,cpus]:groups){
+            cores.push_back(cpus);
+        }
+        // 按每组最小的CPU排序
+        std::sort(cores.begin(),cores.end());
+        return cores;
+    }
+    // 所在物理核心
+    int Placement::core_of(int cpu) const{
+        for(size_t i=0; i<_cores.size(); i++){
+            if(std::find(_cores[i].begin(),_cores[i].end(),cpu)!=_cores[i].end()){
+                return i;
+            }
+        }
+        return -1;
+    }
+    // 设置拓扑和分配
+    void Placement::configure(const std::vector<std::vector<int>> &cores,const std::vector<int> &solution,const std::vector<int> &helper){
+        std::lock_guard<std::mutex> guard(_lock);
+        _cores=cores;
+        _solution=solution;
+        _helper=helper;
+        for(int cpu:_solution){
+            if(core_of(cpu)==-1){
+                throw std::runtime_error("Placement: 计时CPU不可用: "+std::to_string(cpu));
+            }
+        }
+        for(int cpu:_helper){
+            if(core_of(cpu)==-1){
+                throw std::runtime_error("Placement: 辅助CPU不可用: "+std::to_string(cpu));
+            }
+        }
+        if(_solution.empty()&&!_cores.empty()&&!_helper.empty()){
+            // 保留指定的辅助CPU,计时CPU只从不包含辅助CPU的核心中选择,每个核心一个逻辑CPU
+            for(const auto &core:_cores){
+                bool helping=std::any_of(core.begin(),core.end(),[&](int cpu){
+                    return std::find(_helper.begin(),_helper.end(),cpu)!=_helper.end();
+                    });
+                if(!helping){
+                    _solution.push_back(core[0]);
+                }
+            }
+            // 辅助CPU覆盖全部核心时只能共用
+            if(_solution.empty()){
+                _solution={ _cores[0][0] };
+            }
+        }
+        else if(_solution.empty()&&!_cores.empty()){
+            if(_cores.size()==1){
+                _solution={ _cores[0][0] };
+                _helper=_cores[0];
+            }
+            else{
+                size_t count=std::max<size_t>(1,_cores.size()/2);
+                _helper.clear();
+                for(size_t i=0; i<_cores.size(); i++){
+                    if(i<count){
+                        _solution.push_back(_cores[i][0]);
+                    }
+                    else{
+                        _helper.insert(_helper.end(),_cores[i].begin(),_cores[i].end());
+                    }
+                }
+            }
+        }
+        if(_helper.empty()){
+            // 没有指定辅助CPU时使用计时核心之外的全部CPU
+            for(const auto &core:_cores){
+                bool timed=std::any_of(core.begin(),core.end(),[&](int cpu){
+                    return std::find(_solution.begin(),_solution.end(),cpu)!=_solution.end();
+                    });
+                if(!timed){
+                    _helper.insert(_helper.end(),core.begin(),core.end());
+                }
+            }
+            if(_helper.empty()){
+                _helper=_solution;
+            }
+        }
+        _busy.assign(_solution.size(),false);
+    }
+    // 计时CPU
+    const std::vector<int> &Placement::solution() const{
+        return _solution;
+    }
+    // 辅助CPU
+    const std::vector<int> &Placement::helper() const{
+        return _helper;
+    }
+    // 计时CPU是否共用物理核心
+    bool Placement::shared() const{
+        std::vector<int> used;
+        for(int cpu:_solution){
+            int core=core_of(cpu);
+            if(std::find(used.begin(),used.end(),core)!=used.end()){
+                return true;
+            }
+            used.push_back(core);
+        }
+        for(int cpu:_helper){
+            if(std::find(used.begin(),used.end(),core_of(cpu))!=used.end()){
+                return true;
+            }
+        }
+        return false;
+    }
+    // 占用计时CPU
+    int Placement::acquire(){
+        std::unique_lock<std::mutex> guard(_lock);
+        if(_solution.empty()){
+            return -1;
+        }
+        while(true){
+            for(size_t i=0; i<_solution.size(); i++){
+                if(!_busy[i]){
+                    _busy[i]=true;
+                    return _solution[i];
+                }
+            }
+            _free.wait(guard);
+        }
+    }
+    // 释放计时CPU
+    void Placement::release(int cpu){
+        {
+            std::lock_guard<std::mutex> guard(_lock);
+            for(size_t i=0; i<_solution.size(); i++){
+                if(_solution[i]==cpu){
+                    _busy[i]=false;
+                }
+            }
+        }
+        _free.notify_one();
+    }
+    // 绑定到辅助CPU
+    bool Placement::bind_helper() const{
+        if(_helper.empty()){
+            return false;
+        }
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        for(int cpu:_helper){
+            CPU_SET(cpu,&set);
+        }
+        return sched_setaffinity(0,sizeof(set),&set)==0;
+    }
+    // 分配说明
+    string Placement::report() const{
+        auto join=[](const std::vector<int> &cpus){
+            string res;
+            for(int cpu:cpus){
+                res+=(res.empty()?"":",")+std::to_string(cpu);
+            }
+            return res;
+        };
+        return std::to_string(_cores.size())+"个物理核心, 计时CPU ["+join(_solution)+"], 辅助CPU ["+join(_helper)+"]";
+    }
+}
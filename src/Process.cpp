@@ -6,6 +6,8 @@
 #include <fcntl.h>
 #include <unistd.h>
 #include <errno.h>
+#include <sched.h>
+#include <string.h>
 
 namespace process{
     // 进程类
@@ -23,6 +25,31 @@ namespace process{
         return *this;
     }
 
+    Process &Process::set_affinity(const std::vector<int> &cpus){
+        _cpus=cpus;
+        return *this;
+    }
+
+    Process &Process::set_counters(bool enable){
+        _counting=enable;
+        return *this;
+    }
+
+    std::vector<int> Process::allowed_cpus(){
+        std::vector<int> cpus;
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        if(sched_getaffinity(0,sizeof(set),&set)==-1){
+            return cpus;
+        }
+        for(int cpu=0; cpu<CPU_SETSIZE; cpu++){
+            if(CPU_ISSET(cpu,&set)){
+                cpus.push_back(cpu);
+            }
+        }
+        return cpus;
+    }
+
     Process &Process::set_memout(int memout_mb){
         _memsize=memout_mb;
         return *this;
@@ -43,48 +70,97 @@ namespace process{
     void Process::start_timer(){
         if(_timelimit>0){
             _timer.stop();  // 确保停止任何现有的计时器
-            _timer.start(_timelimit,[this](){
-                if(is_running()){
+            // 只终止启动时的子进程,回收之后 pid 可能被其他线程的子进程复用
+            pid_t pid=_pid;
+            _timer.start(_timelimit,[this,pid](){
+                std::lock_guard<std::mutex> guard(_exitLock);
+                if(!_exited){
                     _status=TIMEOUT;  // 设置状态为超时
-                    ::kill(_pid,SIGKILL);      // 发送终止信号
+                    ::kill(pid,SIGKILL);      // 发送终止信号
                 }
                 });
         }
     }
+    // 子进程中输出错误,只使用异步信号安全的函数
+    static void child_error(const char *message){
+        ssize_t unused=::write(STDERR_FILENO,message,strlen(message));
+        (void)unused;
+    }
+    // 按 execvp 的规则在 PATH 中查找程序, fork 之后只能调用 execve
+    static string resolve_program(const char *arg,const char *path){
+        if(strchr(arg,'/')!=nullptr){
+            return arg;
+        }
+        std::istringstream stream(path!=nullptr?path:"/bin:/usr/bin");
+        string dir;
+        while(std::getline(stream,dir,':')){
+            string file=(dir.empty()?".":dir)+"/"+arg;
+            if(::access(file.c_str(),X_OK)==0){
+                return file;
+            }
+        }
+        return arg;
+    }
     void Process::launch(const char arg[],char *args[]){
+        // 计数器需要在子进程 exec 之前打开,子进程等待父进程写入闸门
+        // 多个线程同时启动时子进程会继承其他子进程闸门的写端,不能等待 EOF
+        int gate[2]={ -1,-1 };
+        if(_counting&&pipe2(gate,O_CLOEXEC)==-1){
+            gate[0]=gate[1]=-1;
+        }
+        _counterValues=CounterValues();
+        _exited=false;
+        // 多线程程序 fork 之后子进程只能调用异步信号安全的函数,环境变量、程序路径和错误信息都在 fork 之前准备
+        std::vector<string> envs;
+        for(char **env=environ; *env!=nullptr; env++){
+            string item=*env;
+            if(_env_vars.count(item.substr(0,item.find('=')))==0){
+                envs.push_back(item);
+            }
+        }
+        for(const auto &[key,value]:_env_vars){
+            envs.push_back(key+"="+value);
+        }
+        std::vector<char *> envp;
+        for(auto &item:envs){
+            envp.push_back(item.data());
+        }
+        envp.push_back(nullptr);
+        auto path=_env_vars.find("PATH");
+        string program=resolve_program(arg,path!=_env_vars.end()?path->second.c_str():std::getenv("PATH"));
+        string missing=name+":子程序不存在！路径:"+string(arg)+"\n";
+        string failed=name+":子程序执行失败!\n";
+        Handle in=_stdin[PIPE_READ],out=_stdout[PIPE_WRITE],err=_stderr[PIPE_WRITE],message=_child_message[PIPE_WRITE];
+        struct rlimit rl;
+        rl.rlim_cur=rl.rlim_max=(rlim_t)_memsize*1024*1024;
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        for(int cpu:_cpus){
+            CPU_SET(cpu,&set);
+        }
         _pid=fork();
         // 子进程
         if(_pid==0){
-            // 设置环境变量
-            for(const auto &[name,value]:_env_vars){
-                setenv(name.c_str(),value.c_str(),1);
-            }
-
             // 限制内存大小
-            if(_memsize!=0){
-                struct rlimit rl;
-                rl.rlim_cur=_memsize*1024*1024; // 软限制
-                rl.rlim_max=_memsize*1024*1024; // 硬限制
-
-                if(setrlimit(RLIMIT_AS,&rl)==-1){
-                    perror("setrlimit failed");
-                    exit(EXIT_FAILURE);
-                }
+            if(_memsize!=0&&setrlimit(RLIMIT_AS,&rl)==-1){
+                child_error("setrlimit failed\n");
+                _exit(EXIT_FAILURE);
             }
 
-            // 设置管道
-            _stdin.set_type(PIPE_READ);
-            _stdout.set_type(PIPE_WRITE);
-            _stderr.set_type(PIPE_WRITE);
+            // 绑定CPU,失败时沿用父进程的亲和性
+            if(!_cpus.empty()){
+                sched_setaffinity(0,sizeof(set),&set);
+            }
 
-            // 输入输出重定向
-            _stdin.redirect(STDIN_FILENO);
-            _stdout.redirect(STDOUT_FILENO);
-            _stderr.redirect(STDERR_FILENO);
+            // 输入输出重定向,管道的其他端带有 O_CLOEXEC, exec 时自动关闭
+            if(::dup2(in,STDIN_FILENO)==-1||::dup2(out,STDOUT_FILENO)==-1||::dup2(err,STDERR_FILENO)==-1){
+                child_error("Failed to redirect pipe\n");
+                _exit(EXIT_FAILURE);
+            }
 
             // 通讯 进程开始
-            _child_message.set_type(PIPE_WRITE);
-            _child_message<<"Start"<<std::endl;
+            ssize_t unused=::write(message,"Start\n",6);
+            (void)unused;
 
             // 重定向到文件
             if(_stdin_fd!=-1){
@@ -94,22 +170,39 @@ namespace process{
                 ::dup2(_stdout_fd,STDOUT_FILENO);
             }
 
-            // 运行子程序
-            if(execvp(arg,args)==-1){
-                if(!fs::exists(arg)){
-                    std::cerr<<""+name+":子程序不存在！路径:"+string(arg)<<std::endl;
-                }
-                else{
-                    std::cerr<<""+name+":子程序执行失败!"<<std::endl;
-                }
-                exit(10);
+            // 等待计数器打开
+            if(gate[0]!=-1){
+                ::close(gate[1]);
+                char signal;
+                while(::read(gate[0],&signal,1)==-1&&errno==EINTR){}
+                ::close(gate[0]);
             }
+
+            // 运行子程序
+            execve(program.c_str(),args,envp.data());
+            const string &error=errno==ENOENT?missing:failed;
+            unused=::write(STDERR_FILENO,error.data(),error.size());
+            _exit(10);
         }
         else if(_pid<0){
+            if(gate[0]!=-1){
+                ::close(gate[0]);
+                ::close(gate[1]);
+            }
             _status=ERROR;
             throw std::runtime_error(name+":子程序创建失败！");
         }
         _status=RUNNING;
+        _startTime=std::chrono::steady_clock::now();
+        // 重定向文件已经交给子进程,父进程关闭避免描述符泄漏
+        if(_stdin_fd!=-1){
+            ::close(_stdin_fd);
+            _stdin_fd=-1;
+        }
+        if(_stdout_fd!=-1){
+            ::close(_stdout_fd);
+            _stdout_fd=-1;
+        }
         _stdin.set_type(PIPE_WRITE);
         _stdout.set_type(PIPE_READ);
         _stderr.set_type(PIPE_READ);
@@ -122,6 +215,13 @@ namespace process{
         // if(!_child_message.is_blocked()){
         //     _child_message.set_blocked(false);
         // }
+        if(gate[0]!=-1){
+            ::close(gate[0]);
+            _counters.open(_pid);
+            char signal=1;
+            while(::write(gate[1],&signal,1)==-1&&errno==EINTR){}
+            ::close(gate[1]);
+        }
         if(start_signal!="Start"){
             _status=ERROR;
             throw std::runtime_error(name+":未获取到开始信号，子程序启动失败！");
@@ -161,8 +261,27 @@ namespace process{
     }
 
     Status Process::wait(){
-        int status;
-        waitpid(_pid,&status,0);
+        // 已经回收过,不能用 -1 调用 wait4,否则会回收其他线程的子进程
+        if(_pid<=0){
+            return _status;
+        }
+        // 先等待结束但不回收,停止计时器之后再回收,计时器不会终止已经复用的 pid
+        siginfo_t info;
+        while(waitid(P_PID,_pid,&info,WEXITED|WNOWAIT)==-1&&errno==EINTR){}
+        {
+            std::lock_guard<std::mutex> guard(_exitLock);
+            _exited=true;
+        }
+        _timer.stop();
+        int status=0,result;
+        while((result=wait4(_pid,&status,0,&_usage))==-1&&errno==EINTR){}
+        if(result>0){
+            _endTime=std::chrono::steady_clock::now();
+        }
+        if(_counting){
+            _counterValues=_counters.read();
+            _counters.close();
+        }
         _exit_code=status;
         _pid=-1;
         if(_status==TIMEOUT){
@@ -188,10 +307,6 @@ namespace process{
             _status=RE;
             return _status;
         }
-        // 停止计时
-        if(_status!=RUNNING){
-            _timer.stop();
-        }
     }
 
     int Process::get_exit_code() const{
@@ -202,6 +317,29 @@ namespace process{
         return _status;
     }
 
+    int Process::get_time() const{
+        long ms=(_usage.ru_utime.tv_sec+_usage.ru_stime.tv_sec)*1000L+
+            (_usage.ru_utime.tv_usec+_usage.ru_stime.tv_usec)/1000L;
+        return (int)ms;
+    }
+
+    long long Process::get_time_us() const{
+        return (_usage.ru_utime.tv_sec+_usage.ru_stime.tv_sec)*1000000LL+
+            _usage.ru_utime.tv_usec+_usage.ru_stime.tv_usec;
+    }
+
+    int Process::get_wall_time() const{
+        return (int)std::chrono::duration_cast<std::chrono::milliseconds>(_endTime-_startTime).count();
+    }
+
+    long Process::get_memory() const{
+        return _usage.ru_maxrss;
+    }
+
+    const CounterValues &Process::get_counters() const{
+        return _counterValues;
+    }
+
     Process &Process::write(const string &data){
         if(_stdin.is_closed()){
             throw std::runtime_error(name+":进程写入错误！");
@@ -275,6 +413,14 @@ namespace process{
         // 字节读
         return read(PIPE_ERR,nbytes);
     }
+    string Process::get_report(){
+        // 行读,保留每一行的换行
+        string result;
+        while(!_stderr.empty()){
+            result+=_stderr.read_line('\n')+"\n";
+        }
+        return result;
+    }
     char Process::getchar(){
         return read_char(PIPE_OUT);
     }
@@ -320,13 +466,13 @@ namespace process{
         if(file.empty()){
             throw std::invalid_argument(name+":设置stdin文件路径错误！");
         }
-        _stdin_fd=::open(file.c_str(),O_RDONLY);
+        _stdin_fd=::open(file.c_str(),O_RDONLY|O_CLOEXEC);
     }
     void Process::set_stdout(fs::path file){
         if(file.empty()){
             throw std::invalid_argument(name+":设置stdout文件路径错误！");
         }
-        _stdout_fd=::open(file.c_str(),O_WRONLY|O_CREAT|O_TRUNC,0666);
+        _stdout_fd=::open(file.c_str(),O_WRONLY|O_CREAT|O_TRUNC|O_CLOEXEC,0666);
     }
     void Process::close(PipeType type){
         if(type==PIPE){
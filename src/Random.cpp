@@ -0,0 +1,63 @@
+#include "Random.h"
+#include <random>
+#include <chrono>
+
+namespace acm{
+    // 黄金分割常数
+    static const uint64_t golden=0x9e3779b97f4a7c15ull;
+    // SplitMix64 混合函数
+    uint64_t splitmix64(uint64_t x){
+        x=(x^(x>>30))*0xbf58476d1ce4e5b9ull;
+        x=(x^(x>>27))*0x94d049bb133111ebull;
+        return x^(x>>31);
+    }
+    // 派生子密钥
+    uint64_t derive(uint64_t master,uint64_t index,uint64_t stream){
+        return splitmix64(splitmix64(master+golden*(index+1))^splitmix64(stream*golden));
+    }
+    // 构造函数
+    CounterRng::CounterRng(uint64_t key):_key(key){}
+    // 下一个随机数
+    uint64_t CounterRng::next(){
+        return splitmix64(_key+golden*(++_counter));
+    }
+    // [0,bound) 范围内的随机数
+    uint64_t CounterRng::below(uint64_t bound){
+        if(bound==0){
+            return 0;
+        }
+        // 拒绝采样消除取模偏差
+        uint64_t limit=UINT64_MAX-UINT64_MAX%bound;
+        uint64_t x;
+        do{
+            x=next();
+        }
+        while(x>=limit);
+        return x%bound;
+    }
+    // 按权重选择下标
+    int weighted_index(const std::vector<int> &weights,uint64_t draw){
+        uint64_t total=0;
+        for(int w:weights){
+            total+=w>0?w:0;
+        }
+        if(total==0){
+            return 0;
+        }
+        uint64_t point=draw%total;
+        for(size_t i=0; i<weights.size(); i++){
+            uint64_t w=weights[i]>0?weights[i]:0;
+            if(point<w){
+                return i;
+            }
+            point-=w;
+        }
+        return 0;
+    }
+    // 生成新的主种子
+    uint64_t random_master(){
+        std::random_device rd;
+        uint64_t seed=((uint64_t)rd()<<32)^rd();
+        return splitmix64(seed^std::chrono::system_clock::now().time_since_epoch().count());
+    }
+}
@@ -0,0 +1,221 @@
+#include "Reducer.h"
+#include <thread>
+#include <algorithm>
+
+namespace acm{
+    // 构造函数
+    Reducer::Reducer(Oracle oracle,int jobs):_oracle(oracle),_jobs(jobs>0?jobs:1){}
+    // 设置判定次数上限
+    void Reducer::set_budget(size_t budget){
+        _budget=budget;
+    }
+    // 已经判定的次数
+    size_t Reducer::tests() const{
+        return _tests;
+    }
+    // 并行判定候选
+    int Reducer::first(const std::vector<Tokens> &candidates){
+        for(size_t begin=0; begin<candidates.size(); begin+=_jobs){
+            if(_tests>=_budget){
+                return -1;
+            }
+            size_t end=std::min(candidates.size(),begin+_jobs);
+            std::vector<char> ok(end-begin,0);
+            std::vector<std::thread> threads;
+            for(size_t i=begin; i<end; i++){
+                threads.emplace_back([&,i](){
+                    ok[i-begin]=_oracle(join_tokens(candidates[i]));
+                    });
+            }
+            for(auto &thread:threads){
+                thread.join();
+            }
+            _tests+=end-begin;
+            // 取编号最小的有效候选,结果与线程数无关
+            for(size_t i=begin; i<end; i++){
+                if(ok[i-begin]){
+                    return i;
+                }
+            }
+        }
+        return -1;
+    }
+    // 删除元素后修正数量头
+    std::vector<Tokens> Reducer::fix_counts(const Tokens &tokens,size_t line,long removed,long oldCount){
+        std::vector<Tokens> result;
+        auto fix=[&](size_t h,size_t i,long delta){
+            long value=std::stol(tokens[h][i]);
+            if(value-delta<0){
+                return;
+            }
+            Tokens temp=tokens;
+            temp[h][i]=std::to_string(value-delta);
+            result.push_back(temp);
+        };
+        // 附近的行中等于原数量的整数
+        size_t low=line>=3?line-3:0;
+        for(size_t h=line; h-->low;){
+            for(size_t i=0; i<tokens[h].size(); i++){
+                if(!is_integer(tokens[h][i])){
+                    continue;
+                }
+                long value=std::stol(tokens[h][i]);
+                if(oldCount>=0?value==oldCount:value>=removed){
+                    fix(h,i,removed);
+                }
+            }
+        }
+        // 第一行通常是数据组数
+        if(line>3&&!tokens.empty()){
+            for(size_t i=0; i<tokens[0].size(); i++){
+                if(is_integer(tokens[0][i])){
+                    fix(0,i,1);
+                }
+            }
+        }
+        return result;
+    }
+    // 删除行
+    bool Reducer::reduce_lines(Tokens &tokens){
+        bool changed=false;
+        size_t n=2;
+        while(tokens.size()>1&&_tests<_budget){
+            size_t size=tokens.size();
+            n=std::min(n,size);
+            size_t chunk=(size+n-1)/n;
+            std::vector<Tokens> candidates;
+            for(size_t begin=0; begin<size; begin+=chunk){
+                size_t end=std::min(size,begin+chunk);
+                Tokens temp;
+                temp.insert(temp.end(),tokens.begin(),tokens.begin()+begin);
+                temp.insert(temp.end(),tokens.begin()+end,tokens.end());
+                candidates.push_back(temp);
+                // 删除的行可能由前面的数量头决定
+                for(auto &fixed:fix_counts(temp,begin,end-begin,-1)){
+                    candidates.push_back(fixed);
+                }
+            }
+            int index=first(candidates);
+            if(index>=0){
+                tokens=candidates[index];
+                changed=true;
+                n=std::max<size_t>(n-1,2);
+                continue;
+            }
+            if(chunk==1){
+                break;
+            }
+            n=std::min(n*2,size);
+        }
+        return changed;
+    }
+    // 删除行内元素
+    bool Reducer::reduce_elements(Tokens &tokens){
+        bool changed=false;
+        for(size_t line=0; line<tokens.size()&&_tests<_budget; line++){
+            size_t n=2;
+            while(tokens[line].size()>1&&_tests<_budget){
+                size_t size=tokens[line].size();
+                n=std::min(n,size);
+                size_t chunk=(size+n-1)/n;
+                std::vector<Tokens> candidates;
+                for(size_t begin=0; begin<size; begin+=chunk){
+                    size_t end=std::min(size,begin+chunk);
+                    Tokens temp=tokens;
+                    auto &row=temp[line];
+                    row.erase(row.begin()+begin,row.begin()+end);
+                    candidates.push_back(temp);
+                    long removed=end-begin;
+                    // 同一行开头的数量头
+                    if(begin>0&&is_integer(row[0])&&std::stol(row[0])==(long)size-1){
+                        Tokens fixed=temp;
+                        fixed[line][0]=std::to_string(size-1-removed);
+                        candidates.push_back(fixed);
+                    }
+                    // 前面几行中的数量头
+                    for(auto &fixed:fix_counts(temp,line,removed,size)){
+                        candidates.push_back(fixed);
+                    }
+                }
+                int index=first(candidates);
+                if(index>=0){
+                    tokens=candidates[index];
+                    changed=true;
+                    n=std::max<size_t>(n-1,2);
+                    continue;
+                }
+                if(chunk==1){
+                    break;
+                }
+                n=std::min(n*2,size);
+            }
+        }
+        return changed;
+    }
+    // 缩小数字
+    bool Reducer::reduce_numbers(Tokens &tokens){
+        bool changed=false;
+        for(size_t line=0; line<tokens.size(); line++){
+            for(size_t i=0; i<tokens[line].size()&&_tests<_budget; i++){
+                while(is_integer(tokens[line][i])&&_tests<_budget){
+                    long value=std::stol(tokens[line][i]);
+                    // 从小到大尝试,第一个有效的就是最小的
+                    std::vector<long> values;
+                    for(long v:{ 0L,1L,-1L,value/2,value>0?value-1:value+1 }){
+                        if(std::labs(v)<std::labs(value)||(std::labs(v)==std::labs(value)&&v>value)){
+                            if(std::find(values.begin(),values.end(),v)==values.end()){
+                                values.push_back(v);
+                            }
+                        }
+                    }
+                    std::vector<Tokens> candidates;
+                    // 相等的数字往往相互关联,先尝试一起缩小
+                    string old=tokens[line][i];
+                    size_t same=0;
+                    for(const auto &row:tokens){
+                        same+=std::count(row.begin(),row.end(),old);
+                    }
+                    for(long v:values){
+                        if(same>1){
+                            Tokens temp=tokens;
+                            for(auto &row:temp){
+                                std::replace(row.begin(),row.end(),old,std::to_string(v));
+                            }
+                            candidates.push_back(temp);
+                        }
+                        Tokens temp=tokens;
+                        temp[line][i]=std::to_string(v);
+                        candidates.push_back(temp);
+                    }
+                    int index=first(candidates);
+                    if(index<0){
+                        break;
+                    }
+                    tokens=candidates[index];
+                    changed=true;
+                }
+            }
+        }
+        return changed;
+    }
+    // 最小化
+    string Reducer::reduce(const string &data){
+        Tokens tokens=split_tokens(data);
+        // 规范化空白后无法复现时不做处理
+        if(join_tokens(tokens)!=data){
+            _tests++;
+            if(!_oracle(join_tokens(tokens))){
+                return data;
+            }
+        }
+        while(_tests<_budget){
+            bool changed=reduce_lines(tokens);
+            changed|=reduce_elements(tokens);
+            changed|=reduce_numbers(tokens);
+            if(!changed){
+                break;
+            }
+        }
+        return join_tokens(tokens);
+    }
+}
@@ -0,0 +1,81 @@
+#include "Stats.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace acm{
+    // 中位数
+    double median(std::vector<double> values){
+        if(values.empty()){
+            return 0;
+        }
+        size_t mid=values.size()/2;
+        std::nth_element(values.begin(),values.begin()+mid,values.end());
+        if(values.size()%2){
+            return values[mid];
+        }
+        double upper=values[mid];
+        double lower=*std::max_element(values.begin(),values.begin()+mid);
+        return (lower+upper)/2;
+    }
+    // 学生t分布的0.975分位数
+    double t_975(size_t df){
+        static const double table[]={
+            0,12.706,4.303,3.182,2.776,2.571,2.447,2.365,2.306,2.262,2.228,
+            2.201,2.179,2.160,2.145,2.131,2.120,2.110,2.101,2.093,2.086,
+            2.080,2.074,2.069,2.064,2.060,2.056,2.052,2.048,2.045,2.042
+        };
+        if(df==0){
+            return std::numeric_limits<double>::infinity();
+        }
+        if(df<sizeof(table)/sizeof(table[0])){
+            return table[df];
+        }
+        return 1.96;
+    }
+    // 斜率95%置信区间的半宽
+    double LinearFit::half_width() const{
+        if(n<3){
+            return std::numeric_limits<double>::infinity();
+        }
+        return t_975(n-2)*slopeError;
+    }
+    // 预测值
+    double LinearFit::predict(double x) const{
+        return slope*x+intercept;
+    }
+    // 拟合
+    LinearFit linear_fit(const std::vector<double> &x,const std::vector<double> &y){
+        LinearFit fit;
+        size_t n=std::min(x.size(),y.size());
+        if(n<2){
+            return fit;
+        }
+        double mx=0,my=0;
+        for(size_t i=0; i<n; i++){
+            mx+=x[i];
+            my+=y[i];
+        }
+        mx/=n;
+        my/=n;
+        double sxx=0,sxy=0,syy=0;
+        for(size_t i=0; i<n; i++){
+            sxx+=(x[i]-mx)*(x[i]-mx);
+            sxy+=(x[i]-mx)*(y[i]-my);
+            syy+=(y[i]-my)*(y[i]-my);
+        }
+        if(sxx==0){
+            return fit;
+        }
+        fit.n=n;
+        fit.slope=sxy/sxx;
+        fit.intercept=my-fit.slope*mx;
+        // 残差平方和
+        double sse=std::max(0.0,syy-fit.slope*sxy);
+        fit.r2=syy>0?1-sse/syy:1;
+        if(n>2){
+            fit.slopeError=std::sqrt(sse/(n-2)/sxx);
+        }
+        return fit;
+    }
+}
@@ -0,0 +1,44 @@
+#include "Tokens.h"
+#include <sstream>
+#include <algorithm>
+
+namespace acm{
+    // 切分
+    Tokens split_tokens(const string &data){
+        Tokens tokens;
+        std::istringstream lines(data);
+        string line;
+        while(std::getline(lines,line)){
+            std::istringstream words(line);
+            std::vector<string> temp;
+            string word;
+            while(words>>word){
+                temp.push_back(word);
+            }
+            tokens.push_back(temp);
+        }
+        return tokens;
+    }
+    // 拼接
+    string join_tokens(const Tokens &tokens){
+        string data;
+        for(const auto &line:tokens){
+            for(size_t i=0; i<line.size(); i++){
+                if(i>0){
+                    data+=' ';
+                }
+                data+=line[i];
+            }
+            data+='\n';
+        }
+        return data;
+    }
+    // 是否为整数
+    bool is_integer(const string &token){
+        size_t start=(token.size()>1&&token[0]=='-')?1:0;
+        if(token.size()==start||token.size()-start>18){
+            return false;
+        }
+        return std::all_of(token.begin()+start,token.end(),::isdigit);
+    }
+}
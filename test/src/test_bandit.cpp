@@ -0,0 +1,97 @@
+#include "test_framework.h"
+#include "Bandit.h"
+
+// 按错误率和耗时模拟运行,返回每个臂被选择的次数
+static std::vector<int> simulate(acm::Bandit &bandit, const std::vector<int> &period, const std::vector<double> &cost, int rounds) {
+    std::vector<int> chosen(bandit.size(), 0);
+    for (int i = 0; i < rounds; i++) {
+        size_t arm = bandit.select(i);
+        chosen[arm]++;
+        // 每 period 次运行发现一次错误
+        bool failure = period[arm] > 0 && chosen[arm] % period[arm] == 0;
+        bandit.observe(arm, failure ? acm::Bandit::Outcome_Failure : acm::Bandit::Outcome_Pass, cost[arm]);
+    }
+    return chosen;
+}
+
+TestSuite create_bandit_tests() {
+    TestSuite suite("Bandit调度");
+
+    // 相同密钥和统计得到相同的选择
+    suite.add_test("选择可复现", []() -> std::string {
+        acm::Bandit a, b;
+        for (auto *bandit : { &a, &b }) {
+            bandit->add_arm("x");
+            bandit->add_arm("y");
+            bandit->add_arm("z");
+        }
+        for (uint64_t key = 0; key < 50; key++) {
+            assert_equal(a.select(key), b.select(key), "相同密钥的选择应相同");
+        }
+        return "";
+    });
+
+    // 两种策略都应集中到错误率高的臂
+    suite.add_test("学习错误率", []() -> std::string {
+        for (auto policy : { acm::Bandit::Thompson, acm::Bandit::UCB }) {
+            acm::Bandit bandit(policy);
+            bandit.add_arm("rare");
+            bandit.add_arm("often");
+            bandit.add_arm("never");
+            std::vector<int> chosen = simulate(bandit, { 50, 3, 0 }, { 1, 1, 1 }, 600);
+            assert_true(chosen[1] > chosen[0] && chosen[1] > chosen[2], "错误率高的臂应被选择最多");
+            assert_true(chosen[1] > 300, "错误率高的臂应占多数");
+        }
+        return "";
+    });
+
+    // 错误率相同时选择更快的臂
+    suite.add_test("考虑耗时", []() -> std::string {
+        acm::Bandit bandit;
+        bandit.add_arm("slow");
+        bandit.add_arm("fast");
+        std::vector<int> chosen = simulate(bandit, { 4, 4 }, { 100, 5 }, 400);
+        assert_true(chosen[1] > chosen[0] * 2, "耗时少的臂应被选择更多");
+        return "";
+    });
+
+    // 重复和拒绝的数据降低得分
+    suite.add_test("重复与拒绝", []() -> std::string {
+        acm::Bandit bandit;
+        bandit.add_arm("dup");
+        bandit.observe(0, acm::Bandit::Outcome_Duplicate, 2);
+        bandit.observe(0, acm::Bandit::Outcome_Rejected, 4);
+        const acm::Bandit::Arm &arm = bandit.arm(0);
+        assert_equal(arm.pulls, 2.0, "次数不正确");
+        assert_equal(arm.duplicates, 1.0, "重复次数不正确");
+        assert_equal(arm.rejected, 1.0, "拒绝次数不正确");
+        assert_equal(arm.mean_cost(), 3.0, "平均耗时不正确");
+        return "";
+    });
+
+    // 统计按名称保存和读取
+    suite.add_test("保存与读取", []() -> std::string {
+        acm::Bandit a;
+        a.add_arm("x");
+        a.add_arm("y");
+        a.observe(1, acm::Bandit::Outcome_Failure, 7);
+        acm::Bandit b(acm::Bandit::parse("ucb"));
+        b.add_arm("y");
+        b.add_arm("new");
+        b.load(a.state());
+        assert_equal(b.arm(0).failures, 1.0, "读取的错误次数不正确");
+        assert_equal(b.arm(0).cost, 7.0, "读取的耗时不正确");
+        assert_equal(b.arm(1).pulls, 0.0, "新臂应没有统计");
+        bool thrown = false;
+        try {
+            acm::Bandit::parse("random");
+        }
+        catch (const std::runtime_error &) {
+            thrown = true;
+        }
+        assert_true(thrown, "未知策略应抛出异常");
+        return "";
+    });
+
+    return suite;
+}
@@ -0,0 +1,98 @@
+#include "test_framework.h"
+#include "Compiler.h"
+#include <fstream>
+#include <filesystem>
+
+namespace fs = std::filesystem;
+
+TestSuite create_compiler_tests() {
+    TestSuite suite("Compiler编译缓存");
+
+    // 第二次编译命中缓存
+    suite.add_test("命中缓存", []() -> std::string {
+        fs::path dir = "./test_compiler";
+        fs::remove_all(dir);
+        fs::create_directories(dir / "a");
+        fs::create_directories(dir / "b");
+        std::ofstream(dir / "a" / "main.cpp") << "#include \"add.h\"\nint main(){return add(1,2)==3?0:1;}\n";
+        std::ofstream(dir / "a" / "add.h") << "inline int add(int a,int b){return a+b;}\n";
+        fs::copy_file(dir / "a" / "main.cpp", dir / "b" / "main.cpp");
+        fs::copy_file(dir / "a" / "add.h", dir / "b" / "add.h");
+        acm::Compiler compiler;
+        compiler.set_cache(dir / "cache");
+        acm::CompileResult first = compiler.compile(dir / "a" / "main.cpp", dir / "a" / "main");
+        assert_true(first.ok, "编译失败: " + first.error);
+        assert_true(!first.hit, "第一次编译不应命中缓存");
+        // 另一个文件夹中相同的源文件
+        acm::CompileResult second = compiler.compile(dir / "b" / "main.cpp", dir / "b" / "main");
+        assert_true(second.ok && second.hit, "相同内容应命中缓存");
+        assert_true(fs::exists(dir / "b" / "main"), "命中缓存后目标文件应存在");
+        fs::remove_all(dir);
+        return "";
+    });
+
+    // 头文件改变后失效
+    suite.add_test("头文件改变后失效", []() -> std::string {
+        fs::path dir = "./test_compiler";
+        fs::remove_all(dir);
+        fs::create_directories(dir);
+        std::ofstream(dir / "main.cpp") << "#include \"add.h\"\nint main(){return add(1,2)==3?0:1;}\n";
+        std::ofstream(dir / "add.h") << "inline int add(int a,int b){return a+b;}\n";
+        acm::Compiler compiler;
+        compiler.set_cache(dir / "cache");
+        uint64_t before = compiler.key(dir / "main.cpp");
+        uint64_t source = compiler.source_key(dir / "main.cpp");
+        assert_equal(before, compiler.key(dir / "main.cpp"), "相同内容的缓存键应相同");
+        assert_true(before != compiler.key(dir / "main.cpp", { "-O2" }), "编译参数应影响缓存键");
+        assert_equal(source, compiler.source_key(dir / "main.cpp", { "-O2" }), "编译参数不应影响源码键");
+        std::ofstream(dir / "add.h") << "inline int add(int a,int b){return b+a;}\n";
+        assert_true(before != compiler.key(dir / "main.cpp"), "头文件改变后缓存键应改变");
+        assert_true(source != compiler.source_key(dir / "main.cpp"), "头文件改变后源码键应改变");
+        fs::remove_all(dir);
+        return "";
+    });
+
+    // 预编译头文件
+    suite.add_test("预编译头文件", []() -> std::string {
+        fs::path dir = "./test_compiler";
+        fs::remove_all(dir);
+        fs::create_directories(dir);
+        std::ofstream(dir / "lib.h") << "#ifndef LIB_H\n#define LIB_H\ninline int add(int a,int b){return a+b;}\n#endif\n";
+        std::ofstream(dir / "main.cpp") << "#include \"lib.h\"\nint main(){return add(1,2)==3?0:1;}\n";
+        acm::Compiler compiler;
+        compiler.set_cache(dir / "cache");
+        std::vector<std::string> flags = compiler.precompile(dir / "lib.h");
+        assert_equal(flags.size(), (size_t)2, "预编译头文件构建失败");
+        assert_true(fs::exists(flags[1] + ".gch"), "gch文件不存在");
+        assert_true(compiler.precompile(dir / "lib.h") == flags, "相同头文件应复用预编译结果");
+        acm::CompileResult res = compiler.compile(dir / "main.cpp", dir / "main", flags);
+        assert_true(res.ok, "使用预编译头文件编译失败: " + res.error);
+        // 头文件改变后重新构建
+        std::ofstream(dir / "lib.h") << "#ifndef LIB_H\n#define LIB_H\ninline int add(int a,int b){return b+a;}\n#endif\n";
+        assert_true(compiler.precompile(dir / "lib.h") != flags, "头文件改变后应重新构建");
+        fs::remove_all(dir);
+        return "";
+    });
+
+    // 超过上限时淘汰最久未使用的缓存
+    suite.add_test("淘汰最久未使用", []() -> std::string {
+        fs::path dir = "./test_compiler";
+        fs::remove_all(dir);
+        fs::create_directories(dir / "cache");
+        auto now = fs::file_time_type::clock::now();
+        std::ofstream(dir / "cache" / "old.bin") << std::string(100, 'a');
+        std::ofstream(dir / "cache" / "new.bin") << std::string(100, 'b');
+        fs::last_write_time(dir / "cache" / "old.bin", now - std::chrono::hours(1));
+        fs::last_write_time(dir / "cache" / "new.bin", now);
+        acm::Compiler compiler;
+        compiler.set_cache(dir / "cache");
+        compiler.set_limit(150);
+        compiler.evict();
+        assert_true(!fs::exists(dir / "cache" / "old.bin"), "最久未使用的缓存应被淘汰");
+        assert_true(fs::exists(dir / "cache" / "new.bin"), "最近使用的缓存应保留");
+        fs::remove_all(dir);
+        return "";
+    });
+
+    return suite;
+}
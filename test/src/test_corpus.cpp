@@ -0,0 +1,128 @@
+#include "test_framework.h"
+#include "Corpus.h"
+#include <fstream>
+#include <filesystem>
+
+namespace fs = std::filesystem;
+
+TestSuite create_corpus_tests() {
+    TestSuite suite("Corpus类");
+
+    // 写入后读取
+    suite.add_test("写入与读取", []() -> std::string {
+        fs::path dir = "./test_corpus";
+        fs::remove_all(dir);
+        {
+            acm::Corpus corpus;
+            corpus.open(dir);
+            corpus.put(1, acm::Slot_In, "1 2\n");
+            corpus.put(1, acm::Slot_AC, "3\n");
+            corpus.put(3, acm::Slot_In, "5 6\n");
+            assert_equal(corpus.size(), (size_t)3, "索引大小不正确");
+            assert_true(corpus.has(1, acm::Slot_In), "测试点1输入应存在");
+            assert_true(!corpus.has(1, acm::Slot_Out), "测试点1输出不应存在");
+            assert_true(!corpus.has(2, acm::Slot_In), "测试点2不应存在");
+            assert_equal(std::string(corpus.get(1, acm::Slot_AC)), std::string("3\n"), "读取数据不正确");
+        }
+        // 重新打开后数据仍然存在
+        acm::Corpus corpus;
+        corpus.open(dir);
+        assert_equal(std::string(corpus.get(3, acm::Slot_In)), std::string("5 6\n"), "重新打开后数据不正确");
+        corpus.put(2, acm::Slot_In, "7 8\n");
+        assert_equal(std::string(corpus.get(2, acm::Slot_In)), std::string("7 8\n"), "追加后的数据不正确");
+        assert_equal(std::string(corpus.get(1, acm::Slot_In)), std::string("1 2\n"), "追加后旧数据不正确");
+        corpus.close();
+        fs::remove_all(dir);
+        return "";
+    });
+
+    // 段文件切换
+    suite.add_test("段文件切换", []() -> std::string {
+        fs::path dir = "./test_corpus";
+        fs::remove_all(dir);
+        acm::Corpus corpus;
+        corpus.open(dir);
+        corpus.set_segment_limit(16);
+        std::string a(10, 'a'), b(10, 'b');
+        corpus.put(1, acm::Slot_In, a);
+        corpus.put(2, acm::Slot_In, b);
+        assert_true(fs::exists(dir / "seg00001.dat"), "超过上限应切换到新段");
+        assert_equal(corpus.record(2).slot[acm::Slot_In].segment, (uint32_t)1, "记录的段号不正确");
+        assert_equal(std::string(corpus.get(1, acm::Slot_In)), a, "第一段数据不正确");
+        assert_equal(std::string(corpus.get(2, acm::Slot_In)), b, "第二段数据不正确");
+        corpus.close();
+        fs::remove_all(dir);
+        return "";
+    });
+
+    // 元数据
+    suite.add_test("元数据更新", []() -> std::string {
+        fs::path dir = "./test_corpus";
+        fs::remove_all(dir);
+        acm::Corpus corpus;
+        corpus.open(dir);
+        corpus.put(1, acm::Slot_In, "1\n");
+        acm::CorpusRecord record = corpus.record(1);
+        record.mode = 2;
+        record.verdict = 5;
+        corpus.set_record(1, record);
+        record = corpus.record(1);
+        assert_equal(record.mode, 2, "模式不正确");
+        assert_equal(record.verdict, 5, "判题结果不正确");
+        assert_equal(std::string(corpus.get(1, acm::Slot_In)), std::string("1\n"), "更新元数据不应改变数据");
+        assert_equal(corpus.record(9).verdict, -1, "不存在的记录应为空记录");
+        corpus.close();
+        fs::remove_all(dir);
+        return "";
+    });
+
+    // 丢弃数据
+    suite.add_test("丢弃数据保留记录", []() -> std::string {
+        fs::path dir = "./test_corpus";
+        fs::remove_all(dir);
+        acm::Corpus corpus;
+        corpus.open(dir);
+        corpus.put(1, acm::Slot_In, "1 2\n");
+        acm::CorpusRecord record = corpus.record(1);
+        std::string("abc").copy(record.seed, sizeof(record.seed) - 1);
+        record.mode = 1;
+        corpus.set_record(1, record);
+        corpus.drop(1, acm::Slot_In);
+        assert_true(!corpus.has(1, acm::Slot_In), "丢弃后数据不应存在");
+        record = corpus.record(1);
+        assert_true(record.flags & acm::Record_Used, "丢弃数据后记录应保留");
+        assert_equal(std::string(record.seed), std::string("abc"), "丢弃数据后种子应保留");
+        assert_equal(record.mode, 1, "丢弃数据后模式应保留");
+        corpus.close();
+        fs::remove_all(dir);
+        return "";
+    });
+
+    // 导出与导入
+    suite.add_test("导出与导入", []() -> std::string {
+        fs::path dir = "./test_corpus";
+        fs::remove_all(dir);
+        std::vector<fs::path> dirs = { dir / "inData", dir / "outData", dir / "acData" };
+        {
+            acm::Corpus corpus;
+            corpus.open(dir / "packed");
+            corpus.put(1, acm::Slot_In, "1 1\n");
+            corpus.put(1, acm::Slot_Out, "2\n");
+            corpus.put(1, acm::Slot_AC, "2\n");
+            corpus.put(2, acm::Slot_In, "2 2\n");
+            assert_equal(corpus.export_to(dirs), (size_t)2, "导出数量不正确");
+        }
+        assert_true(fs::exists(dir / "inData" / "data2.in"), "导出的输入文件不存在");
+        assert_true(fs::exists(dir / "acData" / "data1.out"), "导出的输出文件不存在");
+        acm::Corpus corpus;
+        corpus.open(dir / "again");
+        assert_equal(corpus.import_from(dirs), (size_t)2, "导入数量不正确");
+        assert_equal(std::string(corpus.get(1, acm::Slot_Out)), std::string("2\n"), "导入数据不正确");
+        assert_equal(std::string(corpus.get(2, acm::Slot_In)), std::string("2 2\n"), "导入数据不正确");
+        corpus.close();
+        fs::remove_all(dir);
+        return "";
+    });
+
+    return suite;
+}
@@ -0,0 +1,87 @@
+#include "test_framework.h"
+#include "Process.h"
+#include <thread>
+#include <atomic>
+#include <vector>
+
+namespace pc = process;
+
+TestSuite create_counters_tests() {
+    TestSuite suite("Counters性能计数器");
+
+    // 子进程的计数
+    suite.add_test("子进程计数", []() -> std::string {
+        pc::Process proc("/bin/sh", pc::Args("sh").add("-c").add("i=0; while [ $i -lt 2000 ]; do i=$((i+1)); done"));
+        proc.set_counters(true);
+        proc.start();
+        proc.wait();
+        const pc::CounterValues &values = proc.get_counters();
+        // 没有权限或虚拟机没有硬件计数器时允许不可用
+        if (!values.any()) {
+            return "计数器不可用";
+        }
+        if (values.instructions >= 0) {
+            assert_true(values.instructions > 100000, "指令数太少");
+        }
+        if (values.pageFaults >= 0) {
+            assert_true(values.pageFaults > 0, "缺页次数应大于0");
+        }
+        return "指令数: " + std::to_string(values.instructions) + " 缺页: " + std::to_string(values.pageFaults);
+    });
+
+    // 计数从 exec 开始,与父进程无关
+    suite.add_test("计数可重复", []() -> std::string {
+        long long first = -1;
+        for (int i = 0; i < 3; i++) {
+            pc::Process proc("/bin/true", pc::Args("true"));
+            proc.set_counters(true);
+            proc.start();
+            proc.wait();
+            long long value = proc.get_counters().instructions;
+            if (value < 0) {
+                return "指令计数不可用";
+            }
+            if (first < 0) {
+                first = value;
+            }
+            // 同一程序的指令数应在同一量级
+            assert_true(value < first * 2 && value * 2 > first, "指令数波动过大");
+        }
+        return "";
+    });
+
+    // 多个线程同时启动计数运行,子进程不能等待其他子进程的闸门
+    suite.add_test("多线程计数运行", []() -> std::string {
+        std::atomic<int> timeouts{ 0 };
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 8; t++) {
+            threads.emplace_back([&timeouts]() {
+                for (int i = 0; i < 20; i++) {
+                    pc::Process proc("/bin/true", pc::Args("true"));
+                    proc.set_counters(true);
+                    proc.set_timeout(2000);
+                    proc.start();
+                    if (proc.wait() != pc::STOP) {
+                        timeouts++;
+                    }
+                }
+            });
+        }
+        for (auto &thread : threads) {
+            thread.join();
+        }
+        assert_equal(timeouts.load(), 0, "并发计数运行不应超时");
+        return "";
+    });
+
+    // 未启用时没有计数
+    suite.add_test("默认不计数", []() -> std::string {
+        pc::Process proc("/bin/true", pc::Args("true"));
+        proc.start();
+        proc.wait();
+        assert_true(!proc.get_counters().any(), "未启用时不应有计数");
+        return "";
+    });
+
+    return suite;
+}
@@ -0,0 +1,89 @@
+#include "test_framework.h"
+#include "Coverage.h"
+#include "Process.h"
+#include <fstream>
+#include <filesystem>
+
+namespace fs = std::filesystem;
+
+TestSuite create_coverage_tests() {
+    TestSuite suite("Coverage覆盖率");
+
+    // 新边和新的命中次数桶
+    suite.add_test("合并与分桶", []() -> std::string {
+        acm::Coverage coverage;
+        std::vector<uint8_t> trace(acm::CoverageSize, 0);
+        trace[10] = 1;
+        trace[20] = 5;
+        assert_equal(coverage.novelty(trace.data()), (size_t)2, "新覆盖数量不正确");
+        assert_equal(coverage.merge(trace.data()), (size_t)2, "合并的新覆盖数量不正确");
+        assert_equal(coverage.merge(trace.data()), (size_t)0, "重复合并不应有新覆盖");
+        // 同一分桶内的命中次数不算新覆盖
+        trace[20] = 6;
+        assert_equal(coverage.novelty(trace.data()), (size_t)0, "同一分桶不应算新覆盖");
+        // 进入新的分桶
+        trace[20] = 40;
+        assert_equal(coverage.merge(trace.data()), (size_t)1, "新的分桶应算新覆盖");
+        assert_equal(coverage.edges(), (size_t)2, "覆盖的边数量不正确");
+        return "";
+    });
+
+    // 保存与读取
+    suite.add_test("保存与读取", []() -> std::string {
+        fs::path file = "./test_coverage.bin";
+        acm::Coverage coverage;
+        std::vector<uint8_t> trace(acm::CoverageSize, 0);
+        trace[1] = 1;
+        trace[2] = 200;
+        coverage.merge(trace.data());
+        coverage.save(file);
+        acm::Coverage again;
+        assert_true(again.load(file), "读取失败");
+        assert_equal(again.edges(), (size_t)2, "读取后的边数量不正确");
+        assert_equal(again.novelty(trace.data()), (size_t)0, "读取后不应有新覆盖");
+        std::ofstream(file, std::ios::trunc) << "bad";
+        assert_true(!again.load(file), "大小不符时应读取失败");
+        fs::remove(file);
+        return "";
+    });
+
+    // 插桩程序写入共享位图
+    suite.add_test("插桩程序写入位图", []() -> std::string {
+        if (!fs::exists("/usr/bin/g++")) {
+            return "";
+        }
+        fs::path dir = "./test_coverage_dir";
+        fs::remove_all(dir);
+        fs::create_directories(dir);
+        std::ofstream(dir / "rt.cpp") << acm::Coverage::runtime();
+        std::ofstream(dir / "main.cpp") << "#include <cstdio>\nint main(){int n;if(scanf(\"%d\",&n)!=1)return 0;"
+            "long s=0;for(int i=0;i<n;i++){if(i%3)s+=i;else s--;}printf(\"%ld\\n\",s);}\n";
+        process::Args args("g++");
+        args.add((dir / "main.cpp").string()).add((dir / "rt.cpp").string())
+            .add("-fsanitize-coverage=trace-pc").add("-o").add((dir / "main").string());
+        process::Process compile("/usr/bin/g++", args);
+        compile.start();
+        assert_equal(compile.wait(), process::STOP, "编译插桩程序失败");
+        acm::CoverageMap map;
+        map.open(dir / "map");
+        acm::Coverage coverage;
+        auto run = [&](const std::string &input) {
+            map.clear();
+            std::ofstream(dir / "in") << input;
+            process::Process proc((dir / "main").string(), process::Args("main"));
+            proc.set_env(acm::CoverageEnv, map.path().string());
+            proc.set_stdin(dir / "in");
+            proc.start();
+            proc.wait();
+            return coverage.merge(map.data());
+        };
+        assert_true(run("0\n") > 0, "第一次运行应有覆盖");
+        assert_true(run("10\n") > 0, "进入循环应有新覆盖");
+        assert_equal(run("10\n"), (size_t)0, "相同输入不应有新覆盖");
+        map.close();
+        fs::remove_all(dir);
+        return "";
+    });
+
+    return suite;
+}
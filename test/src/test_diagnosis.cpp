@@ -0,0 +1,92 @@
+#include "test_framework.h"
+#include "Diagnosis.h"
+
+TestSuite create_diagnosis_tests() {
+    TestSuite suite("Diagnosis诊断");
+
+    // AddressSanitizer 报告
+    suite.add_test("提取ASan报告", []() -> std::string {
+        std::string output =
+            "=================================================================\n"
+            "==4242==ERROR: AddressSanitizer: heap-buffer-overflow on address 0x602000000014\n"
+            "READ of size 4 at 0x602000000014 thread T0\n"
+            "    #0 0x4011d6 in main /tmp/a.cpp:5\n"
+            "    #1 0x7f00 in __libc_start_main\n"
+            "\n"
+            "0x602000000014 is located 0 bytes after 4-byte region\n"
+            "allocated by thread T0 here:\n"
+            "    #0 0x7f10 in operator new[](unsigned long)\n"
+            "    #1 0x4011a0 in main /tmp/a.cpp:4\n"
+            "\n"
+            "SUMMARY: AddressSanitizer: heap-buffer-overflow /tmp/a.cpp:5 in main\n";
+        std::string report = acm::Diagnosis::sanitizer_report(output);
+        assert_equal(report.find("ERROR: AddressSanitizer: heap-buffer-overflow"), (size_t)0, "第一行应为错误并去掉进程号");
+        assert_true(report.find("READ of size 4") != std::string::npos, "缺少访问信息");
+        assert_true(report.find("main /tmp/a.cpp:5") != std::string::npos, "缺少调用栈");
+        assert_true(report.find("operator new") == std::string::npos, "只应保留第一个调用栈");
+        assert_true(report.find("SUMMARY:") != std::string::npos, "缺少总结行");
+        return "";
+    });
+
+    // UndefinedBehaviorSanitizer 报告与帧数限制
+    suite.add_test("提取UBSan报告", []() -> std::string {
+        std::string output =
+            "a.cpp:3:7: runtime error: signed integer overflow: 2147483647 + 1 cannot be represented in type 'int'\n"
+            "    #0 0x401 in f(int) a.cpp:3\n"
+            "    #1 0x402 in g() a.cpp:8\n"
+            "    #2 0x403 in main a.cpp:12\n"
+            "SUMMARY: UndefinedBehaviorSanitizer: undefined-behavior a.cpp:3:7\n";
+        std::string report = acm::Diagnosis::sanitizer_report(output, 2);
+        assert_equal(report.find("a.cpp:3:7: runtime error: signed integer overflow"), (size_t)0, "第一行应为错误");
+        assert_true(report.find("g() a.cpp:8") != std::string::npos, "缺少调用栈");
+        assert_true(report.find("main a.cpp:12") == std::string::npos, "超过帧数限制的帧应省略");
+        assert_true(report.find("1 帧省略") != std::string::npos, "缺少省略说明");
+        assert_equal(acm::Diagnosis::sanitizer_report("wrong answer\n"), std::string(), "没有错误时应为空");
+        return "";
+    });
+
+    // massif 峰值快照
+    suite.add_test("提取massif峰值", []() -> std::string {
+        std::string content =
+            "desc: (none)\n"
+            "cmd: ./test_code\n"
+            "time_unit: i\n"
+            "#-----------\n"
+            "snapshot=0\n"
+            "#-----------\n"
+            "time=0\n"
+            "mem_heap_B=0\n"
+            "mem_heap_extra_B=0\n"
+            "mem_stacks_B=0\n"
+            "heap_tree=empty\n"
+            "#-----------\n"
+            "snapshot=1\n"
+            "#-----------\n"
+            "time=1000\n"
+            "mem_heap_B=400000000\n"
+            "mem_heap_extra_B=8\n"
+            "mem_stacks_B=0\n"
+            "heap_tree=peak\n"
+            "n1: 400000000 (heap allocation functions) malloc/new/new[], --alloc-fns, etc.\n"
+            " n0: 400000000 0x401234: main (a.cpp:6)\n"
+            "#-----------\n"
+            "snapshot=2\n"
+            "#-----------\n"
+            "mem_heap_B=0\n";
+        std::string report = acm::Diagnosis::massif_report(content);
+        assert_true(report.find("峰值堆内存 400000000 字节") != std::string::npos, "峰值字节数不正确");
+        assert_true(report.find("main (a.cpp:6)") != std::string::npos, "缺少分配位置");
+        assert_true(report.find("snapshot=2") == std::string::npos, "不应包含后面的快照");
+        assert_equal(acm::Diagnosis::massif_report("snapshot=0\nheap_tree=empty\n"), std::string(), "没有峰值快照时应为空");
+        return "";
+    });
+
+    // 查找程序
+    suite.add_test("在PATH中查找程序", []() -> std::string {
+        assert_true(!acm::Diagnosis::which("sh").empty(), "应能找到sh");
+        assert_true(acm::Diagnosis::which("no_such_program_for_diagnosis").empty(), "不存在的程序应返回空路径");
+        return "";
+    });
+
+    return suite;
+}
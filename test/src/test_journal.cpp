@@ -0,0 +1,73 @@
+#include "test_framework.h"
+#include "Journal.h"
+#include <fstream>
+#include <filesystem>
+
+namespace fs = std::filesystem;
+
+TestSuite create_journal_tests() {
+    TestSuite suite("Journal类");
+
+    // 追加后回放
+    suite.add_test("追加与回放", []() -> std::string {
+        fs::path dir = "./test_journal";
+        fs::remove_all(dir);
+        {
+            acm::Journal journal(dir / "progress.journal");
+            journal.append({ { "now_data", 1 } });
+            journal.append({ { "now_data", 2 }, { "judge_status", "Accept" } });
+            assert_equal(journal.size(), (size_t)2, "记录条数不正确");
+        }
+        acm::Journal journal(dir / "progress.journal");
+        nlohmann::json data = { { "now_data", 0 }, { "name", "demo" } };
+        size_t count = journal.replay(data);
+        assert_equal(count, (size_t)2, "回放条数不正确");
+        assert_equal(data["now_data"].get<int>(), 2, "回放结果不正确");
+        assert_equal(data["judge_status"].get<std::string>(), std::string("Accept"), "回放状态不正确");
+        assert_equal(data["name"].get<std::string>(), std::string("demo"), "未记录的字段不应改变");
+        fs::remove_all(dir);
+        return "";
+    });
+
+    // 残缺的尾部记录
+    suite.add_test("残缺记录截断", []() -> std::string {
+        fs::path dir = "./test_journal";
+        fs::remove_all(dir);
+        fs::create_directories(dir);
+        {
+            std::ofstream file(dir / "progress.journal");
+            file << "{\"now_test\":3}\n{\"now_test\":4}\n{\"now_te";
+        }
+        acm::Journal journal(dir / "progress.journal");
+        nlohmann::json data = nlohmann::json::object();
+        assert_equal(journal.replay(data), (size_t)2, "残缺记录不应被回放");
+        assert_equal(data["now_test"].get<int>(), 4, "回放结果不正确");
+        // 截断之后追加的记录可以被正常回放
+        journal.append({ { "now_test", 5 } });
+        acm::Journal again(dir / "progress.journal");
+        assert_equal(again.replay(data), (size_t)3, "截断后追加的记录回放失败");
+        assert_equal(data["now_test"].get<int>(), 5, "截断后回放结果不正确");
+        fs::remove_all(dir);
+        return "";
+    });
+
+    // 压缩
+    suite.add_test("压缩阈值与清空", []() -> std::string {
+        fs::path dir = "./test_journal";
+        fs::remove_all(dir);
+        acm::Journal journal(dir / "progress.journal");
+        journal.set_compact(3);
+        journal.append({ { "now_data", 1 } });
+        journal.append({ { "now_data", 2 } });
+        assert_true(!journal.need_compact(), "未达到阈值不应压缩");
+        journal.append({ { "now_data", 3 } });
+        assert_true(journal.need_compact(), "达到阈值应压缩");
+        journal.clear();
+        assert_equal(fs::file_size(dir / "progress.journal"), (uintmax_t)0, "清空后文件应为空");
+        assert_true(!journal.need_compact(), "清空后不应压缩");
+        fs::remove_all(dir);
+        return "";
+    });
+
+    return suite;
+}
@@ -0,0 +1,77 @@
+#include "test_framework.h"
+#include "Mutator.h"
+#include <set>
+#include <sstream>
+
+// 解析"n\na1 a2 ... an\n"格式
+static bool valid_array(const std::string &data) {
+    std::istringstream in(data);
+    long n, v;
+    if (!(in >> n) || n < 1 || n > 100) {
+        return false;
+    }
+    for (long i = 0; i < n; i++) {
+        if (!(in >> v)) return false;
+    }
+    std::string rest;
+    return !(in >> rest);
+}
+
+TestSuite create_mutator_tests() {
+    TestSuite suite("Mutator数据变异");
+
+    // 相同密钥得到相同的变异序列
+    suite.add_test("变异可复现", []() -> std::string {
+        acm::Mutator a(7), b(7), c(8);
+        for (auto *m : { &a, &b, &c }) {
+            m->add("3\n1 2 3\n");
+            m->add("2\n10 20\n");
+        }
+        bool differ = false;
+        for (int i = 0; i < 20; i++) {
+            std::string x = a.mutate();
+            assert_equal(x, b.mutate(), "相同密钥的变异应相同");
+            differ |= x != c.mutate();
+        }
+        assert_true(differ, "不同密钥的变异应不同");
+        return "";
+    });
+
+    // 变异应产生多样的新输入
+    suite.add_test("变异多样", []() -> std::string {
+        acm::Mutator mutator(1);
+        assert_equal(mutator.mutate(), std::string(""), "没有种子时应返回空");
+        mutator.add("4\n5 6 7 8\n");
+        mutator.add("1\n9\n");
+        assert_equal(mutator.size(), (size_t)2, "种子数量不正确");
+        std::set<std::string> seen;
+        int valid = 0;
+        for (int i = 0; i < 200; i++) {
+            std::string x = mutator.mutate();
+            seen.insert(x);
+            valid += valid_array(x);
+        }
+        assert_true(seen.size() > 50, "变异结果太少");
+        // 复制元素时修正数量头,合法的变异应占一定比例
+        assert_true(valid > 20, "合法变异太少");
+        return "";
+    });
+
+    // 复制元素时修正数量头
+    suite.add_test("修正数量头", []() -> std::string {
+        acm::Mutator mutator(3);
+        mutator.add("3\n1 2 3\n");
+        bool grown = false;
+        for (int i = 0; i < 500 && !grown; i++) {
+            std::string x = mutator.mutate();
+            std::istringstream in(x);
+            long n;
+            in >> n;
+            grown = n == 4 && valid_array(x);
+        }
+        assert_true(grown, "应能得到数量头加一的合法变异");
+        return "";
+    });
+
+    return suite;
+}
@@ -0,0 +1,103 @@
+#include "test_framework.h"
+#include "Placement.h"
+#include <fstream>
+#include <thread>
+#include <atomic>
+
+// 生成假的 sysfs 拓扑
+static fs::path fake_sysfs(const std::vector<std::string> &siblings) {
+    fs::path dir = "./test_placement";
+    fs::remove_all(dir);
+    for (size_t cpu = 0; cpu < siblings.size(); cpu++) {
+        fs::path topology = dir / ("cpu" + std::to_string(cpu)) / "topology";
+        fs::create_directories(topology);
+        std::ofstream(topology / "thread_siblings_list") << siblings[cpu] << "\n";
+    }
+    return dir;
+}
+
+TestSuite create_placement_tests() {
+    TestSuite suite("Placement CPU分配");
+
+    // CPU列表解析
+    suite.add_test("解析CPU列表", []() -> std::string {
+        assert_true(acm::Placement::parse_list("0-3,8") == std::vector<int>({ 0, 1, 2, 3, 8 }), "范围解析错误");
+        assert_true(acm::Placement::parse_list("5\n") == std::vector<int>({ 5 }), "单个CPU解析错误");
+        bool thrown = false;
+        try {
+            acm::Placement::parse_list("a-b");
+        }
+        catch (const std::runtime_error &) {
+            thrown = true;
+        }
+        assert_true(thrown, "格式错误应抛出异常");
+        return "";
+    });
+
+    // 按SMT兄弟分组并自动分配
+    suite.add_test("自动分配", []() -> std::string {
+        fs::path sysfs = fake_sysfs({ "0,4", "1,5", "2,6", "3,7", "0,4", "1,5", "2,6", "3,7" });
+        auto cores = acm::Placement::topology({ 0, 1, 2, 3, 4, 5, 6, 7 }, sysfs);
+        fs::remove_all(sysfs);
+        assert_equal(cores.size(), (size_t)4, "物理核心数量不正确");
+        assert_true(cores[0] == std::vector<int>({ 0, 4 }), "SMT兄弟分组不正确");
+        acm::Placement placement;
+        placement.configure(cores);
+        // 一半的核心用于计时,每个核心一个逻辑CPU,兄弟空闲
+        assert_true(placement.solution() == std::vector<int>({ 0, 1 }), "计时CPU不正确");
+        assert_true(placement.helper() == std::vector<int>({ 2, 6, 3, 7 }), "辅助CPU不正确");
+        assert_true(!placement.shared(), "计时CPU不应共用物理核心");
+        return "";
+    });
+
+    // 指定分配
+    suite.add_test("指定分配", []() -> std::string {
+        std::vector<std::vector<int>> cores = { { 0, 2 }, { 1, 3 } };
+        acm::Placement placement;
+        placement.configure(cores, { 0 }, { 2 });
+        assert_true(placement.shared(), "与辅助CPU共用物理核心应被发现");
+        placement.configure(cores, { 1 });
+        assert_true(placement.helper() == std::vector<int>({ 0, 2 }), "未指定时辅助CPU应为其他核心");
+        bool thrown = false;
+        try {
+            placement.configure(cores, { 9 });
+        }
+        catch (const std::runtime_error &) {
+            thrown = true;
+        }
+        assert_true(thrown, "不可用的CPU应抛出异常");
+        placement.configure({ { 0 } });
+        assert_true(placement.solution() == std::vector<int>({ 0 }) && placement.helper() == std::vector<int>({ 0 }), "单核时应共用");
+        // 只指定辅助CPU时保留它,计时CPU从其他核心中选择
+        placement.configure({ { 0, 4 }, { 1, 5 }, { 2, 6 } }, {}, { 1 });
+        assert_true(placement.helper() == std::vector<int>({ 1 }), "指定的辅助CPU应保留");
+        assert_true(placement.solution() == std::vector<int>({ 0, 2 }), "计时CPU应来自没有辅助CPU的核心");
+        return "";
+    });
+
+    // 计时CPU独占
+    suite.add_test("独占计时CPU", []() -> std::string {
+        acm::Placement placement;
+        placement.configure({ { 0 }, { 1 }, { 2 }, { 3 } });
+        std::atomic<int> running{ 0 }, peak{ 0 };
+        std::vector<std::thread> threads;
+        for (int i = 0; i < 6; i++) {
+            threads.emplace_back([&]() {
+                int cpu = placement.acquire();
+                int now = ++running;
+                int old = peak;
+                while (now > old && !peak.compare_exchange_weak(old, now)) {}
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+                --running;
+                placement.release(cpu);
+            });
+        }
+        for (auto &thread : threads) {
+            thread.join();
+        }
+        assert_true(peak <= 2, "同时占用的计时CPU不应超过计时CPU数量");
+        return "";
+    });
+
+    return suite;
+}
@@ -3,6 +3,9 @@
 #include "JudgeSign.h"
 #include <iostream>
 #include <fstream>
+#include <thread>
+#include <atomic>
+#include <vector>
 
 namespace pc=process;
 
@@ -177,6 +180,78 @@ TestSuite create_process_advanced_tests(){
         return "";
         });
 
+    // 测试绑定CPU
+    suite.add_test("绑定CPU",[]()->std::string{
+        std::vector<int> cpus=pc::Process::allowed_cpus();
+        assert_true(!cpus.empty(),"应至少允许一个CPU");
+        pc::Process affinityProc("/bin/grep",pc::Args("grep").add("Cpus_allowed_list").add("/proc/self/status"));
+        affinityProc.set_affinity({ cpus.back() });
+        affinityProc.start();
+        std::string output=affinityProc.read();
+        affinityProc.wait();
+        assert_true(output.find(":\t"+std::to_string(cpus.back())+"\n")!=std::string::npos,"绑定CPU失败: "+output);
+        return "";
+        });
+
+    // 多个线程同时创建子进程,管道描述符和子进程回收不能互相干扰
+    suite.add_test("多线程并发运行",[]()->std::string{
+        std::atomic<int> failures{ 0 };
+        std::vector<std::thread> threads;
+        for(int t=0; t<8; t++){
+            threads.emplace_back([&failures](){
+                for(int i=0; i<200; i++){
+                    try{
+                        pc::Process trueProc("/bin/true",pc::Args("true"));
+                        trueProc.start();
+                        if(trueProc.wait()!=pc::STOP){
+                            failures++;
+                        }
+                    }
+                    catch(const std::exception &){
+                        failures++;
+                    }
+                }
+                });
+        }
+        for(auto &thread:threads){
+            thread.join();
+        }
+        assert_equal(failures.load(),0,"并发运行出现失败");
+        return "";
+        });
+
+    // 超时计时器只终止自己启动的子进程
+    suite.add_test("多线程超时不影响其他进程",[]()->std::string{
+        std::atomic<int> failures{ 0 };
+        std::vector<std::thread> threads;
+        for(int t=0; t<8; t++){
+            threads.emplace_back([&failures,t](){
+                for(int i=0; i<200; i++){
+                    try{
+                        pc::Process trueProc("/bin/true",pc::Args("true"));
+                        // 一半线程的计时器在子进程结束前后触发
+                        if(t%2==0){
+                            trueProc.set_timeout(1);
+                        }
+                        trueProc.start();
+                        pc::Status status=trueProc.wait();
+                        if(t%2==1&&status!=pc::STOP){
+                            failures++;
+                        }
+                    }
+                    catch(const std::exception &){
+                        failures++;
+                    }
+                }
+                });
+        }
+        for(auto &thread:threads){
+            thread.join();
+        }
+        assert_equal(failures.load(),0,"其他线程的子进程被终止");
+        return "";
+        });
+
     // 测试标准错误输出
     suite.add_test("标准错误读取",[]()->std::string{
         pc::Process stderrProc("/bin/bash",pc::Args("bash").add("-c").add("echo 'standard output'; echo 'error output' >&2"));
@@ -0,0 +1,57 @@
+#include "test_framework.h"
+#include "Random.h"
+#include <set>
+#include <algorithm>
+
+TestSuite create_random_tests() {
+    TestSuite suite("Random计数器随机数");
+
+    // 相同参数得到相同结果
+    suite.add_test("派生结果可复现", []() -> std::string {
+        uint64_t a = acm::derive(42, 7, acm::Stream_Seed);
+        uint64_t b = acm::derive(42, 7, acm::Stream_Seed);
+        assert_equal(a, b, "相同参数派生结果应相同");
+        assert_true(a != acm::derive(42, 8, acm::Stream_Seed), "不同编号派生结果应不同");
+        assert_true(a != acm::derive(43, 7, acm::Stream_Seed), "不同主种子派生结果应不同");
+        assert_true(a != acm::derive(42, 7, acm::Stream_Mode), "不同随机流派生结果应不同");
+        acm::CounterRng x(a), y(a);
+        for (int i = 0; i < 16; i++) {
+            assert_equal(x.next(), y.next(), "相同密钥的序列应相同");
+        }
+        return "";
+    });
+
+    // 顺序无关
+    suite.add_test("与生成顺序无关", []() -> std::string {
+        std::vector<uint64_t> forward, backward;
+        for (uint64_t i = 1; i <= 100; i++) {
+            forward.push_back(acm::derive(1, i, acm::Stream_Seed));
+        }
+        for (uint64_t i = 100; i >= 1; i--) {
+            backward.push_back(acm::derive(1, i, acm::Stream_Seed));
+        }
+        std::reverse(backward.begin(), backward.end());
+        assert_true(forward == backward, "派生结果不应依赖生成顺序");
+        std::set<uint64_t> unique(forward.begin(), forward.end());
+        assert_equal(unique.size(), (size_t)100, "不同编号的派生结果不应碰撞");
+        return "";
+    });
+
+    // 范围与权重
+    suite.add_test("范围与权重选择", []() -> std::string {
+        acm::CounterRng rng(9);
+        for (int i = 0; i < 1000; i++) {
+            assert_true(rng.below(36) < 36, "随机数超出范围");
+        }
+        assert_equal(acm::weighted_index({ 0, 5, 0 }, 12345), 1, "只有一个非零权重时应选择它");
+        assert_equal(acm::weighted_index({ 0, 0, 0 }, 12345), 0, "权重全为零时应返回0");
+        int count[3] = { 0, 0, 0 };
+        for (uint64_t i = 0; i < 1300; i++) {
+            count[acm::weighted_index({ 10, 1, 2 }, rng.next())]++;
+        }
+        assert_true(count[0] > count[2] && count[2] > 0 && count[1] > 0, "权重分布不正确");
+        return "";
+    });
+
+    return suite;
+}
@@ -0,0 +1,110 @@
+#include "test_framework.h"
+#include "Reducer.h"
+#include <sstream>
+#include <vector>
+
+// 解析"n\na1 a2 ... an\n"格式,格式不合法时返回false
+static bool parse_array(const std::string &data, std::vector<long> &values) {
+    std::istringstream in(data);
+    long n;
+    if (!(in >> n) || n < 0) {
+        return false;
+    }
+    values.assign(n, 0);
+    for (long i = 0; i < n; i++) {
+        if (!(in >> values[i])) {
+            return false;
+        }
+    }
+    std::string rest;
+    return !(in >> rest);
+}
+
+TestSuite create_reducer_tests() {
+    TestSuite suite("Reducer数据最小化");
+
+    // 删除无关行
+    suite.add_test("删除无关行", []() -> std::string {
+        acm::Reducer reducer([](const std::string &data) {
+            return data.find("bad") != std::string::npos;
+        });
+        std::string result = reducer.reduce("a\nb\nbad\nc\nd\ne\n");
+        assert_equal(result, std::string("bad\n"), "应只保留出错的行");
+        return "";
+    });
+
+    // 数量头随元素一起修正
+    suite.add_test("修正数量头", []() -> std::string {
+        // 数组中存在两个相等的元素时"出错",且数据必须合法
+        acm::Reducer reducer([](const std::string &data) {
+            std::vector<long> values;
+            if (!parse_array(data, values)) {
+                return false;
+            }
+            for (size_t i = 0; i < values.size(); i++) {
+                for (size_t j = i + 1; j < values.size(); j++) {
+                    if (values[i] == values[j]) return true;
+                }
+            }
+            return false;
+        });
+        std::string result = reducer.reduce("8\n5 17 3 9 42 17 8 11\n");
+        assert_equal(result, std::string("2\n0 0\n"), "应删除多余元素并修正数量");
+        return "";
+    });
+
+    // 按行存放的元素
+    suite.add_test("修正按行的数量头", []() -> std::string {
+        // 第一行为数量,之后每行一个数,存在大于100的数时"出错"
+        acm::Reducer reducer([](const std::string &data) {
+            std::istringstream in(data);
+            long n, v;
+            bool big = false;
+            if (!(in >> n)) return false;
+            for (long i = 0; i < n; i++) {
+                if (!(in >> v)) return false;
+                big |= v > 100;
+            }
+            std::string rest;
+            return !(in >> rest) && big;
+        });
+        std::string result = reducer.reduce("5\n1\n2\n300\n4\n5\n");
+        assert_equal(result, std::string("1\n101\n"), "应删除多余行并缩小数字");
+        return "";
+    });
+
+    // 结果与线程数无关
+    suite.add_test("并行结果确定", []() -> std::string {
+        auto oracle = [](const std::string &data) {
+            std::vector<long> values;
+            if (!parse_array(data, values)) {
+                return false;
+            }
+            long sum = 0;
+            for (long v : values) sum += v;
+            return sum >= 50;
+        };
+        std::string input = "6\n10 20 30 40 50 60\n";
+        acm::Reducer serial(oracle, 1), parallel(oracle, 4);
+        std::string a = serial.reduce(input);
+        std::string b = parallel.reduce(input);
+        assert_equal(a, b, "单线程与多线程结果应相同");
+        assert_equal(a, std::string("1\n50\n"), "最小化结果不正确");
+        return "";
+    });
+
+    // 判定次数上限
+    suite.add_test("判定次数上限", []() -> std::string {
+        acm::Reducer reducer([](const std::string &data) {
+            return data.find("x") != std::string::npos;
+        });
+        reducer.set_budget(3);
+        std::string input = "1\n2\n3\n4\n5\n6\n7\nx\n";
+        std::string result = reducer.reduce(input);
+        assert_true(reducer.tests() <= 3 + 1, "判定次数超过上限");
+        assert_true(result.find("x") != std::string::npos, "结果必须仍然满足判定");
+        return "";
+    });
+
+    return suite;
+}
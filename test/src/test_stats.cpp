@@ -0,0 +1,58 @@
+#include "test_framework.h"
+#include "Stats.h"
+#include <cmath>
+
+TestSuite create_stats_tests() {
+    TestSuite suite("Stats统计");
+
+    // 中位数
+    suite.add_test("中位数", []() -> std::string {
+        assert_equal(acm::median({ 3, 1, 2 }), 2.0, "奇数个数的中位数不正确");
+        assert_equal(acm::median({ 4, 1, 3, 2 }), 2.5, "偶数个数的中位数不正确");
+        assert_equal(acm::median({ 7, 100, 7, 6, 7 }), 7.0, "中位数应不受异常值影响");
+        assert_equal(acm::median({}), 0.0, "空数组的中位数应为0");
+        return "";
+    });
+
+    // 精确直线
+    suite.add_test("精确直线拟合", []() -> std::string {
+        std::vector<double> x = { 1, 2, 3, 4, 5 }, y;
+        for (double v : x) y.push_back(2 * v + 1);
+        acm::LinearFit fit = acm::linear_fit(x, y);
+        assert_true(std::fabs(fit.slope - 2) < 1e-9, "斜率不正确");
+        assert_true(std::fabs(fit.intercept - 1) < 1e-9, "截距不正确");
+        assert_true(fit.half_width() < 1e-6, "无噪声时置信区间应为0");
+        assert_true(std::fabs(fit.r2 - 1) < 1e-9, "决定系数应为1");
+        assert_true(std::fabs(fit.predict(10) - 21) < 1e-9, "预测值不正确");
+        return "";
+    });
+
+    // 对数坐标的斜率即复杂度的指数
+    suite.add_test("对数斜率", []() -> std::string {
+        std::vector<double> x, y;
+        for (int k = 0; k < 6; k++) {
+            double n = 1000.0 * (1 << k);
+            // 带一点噪声的 n^2
+            double t = n * n * (k % 2 ? 1.05 : 0.95);
+            x.push_back(std::log(n));
+            y.push_back(std::log(t));
+        }
+        acm::LinearFit fit = acm::linear_fit(x, y);
+        assert_true(std::fabs(fit.slope - 2) < 0.1, "斜率应接近2");
+        assert_true(fit.half_width() > 0, "有噪声时置信区间应大于0");
+        assert_true(fit.slope - fit.half_width() < 2 && fit.slope + fit.half_width() > 2, "置信区间应包含真实斜率");
+        return "";
+    });
+
+    // 点数不足
+    suite.add_test("点数不足", []() -> std::string {
+        acm::LinearFit fit = acm::linear_fit({ 1 }, { 1 });
+        assert_equal(fit.n, (size_t)0, "单点不能拟合");
+        fit = acm::linear_fit({ 1, 2 }, { 1, 3 });
+        assert_true(std::isinf(fit.half_width()), "两点时置信区间应为无穷大");
+        assert_equal(acm::t_975(1), 12.706, "t分位数不正确");
+        return "";
+    });
+
+    return suite;
+}
@@ -10,6 +10,18 @@ extern TestSuite create_process_complex_tests();
 extern TestSuite create_keycircle_tests();
 extern TestSuite create_judgesign_tests();
 extern TestSuite create_pipe_tests();  // 添加Pipe测试套件
+extern TestSuite create_journal_tests();
+extern TestSuite create_corpus_tests();
+extern TestSuite create_random_tests();
+extern TestSuite create_compiler_tests();
+extern TestSuite create_reducer_tests();
+extern TestSuite create_stats_tests();
+extern TestSuite create_coverage_tests();
+extern TestSuite create_mutator_tests();
+extern TestSuite create_bandit_tests();
+extern TestSuite create_counters_tests();
+extern TestSuite create_placement_tests();
+extern TestSuite create_diagnosis_tests();
 
 int main(int argc, char** argv) {
     std::cout << "==================================" << std::endl;
@@ -39,6 +51,18 @@ int main(int argc, char** argv) {
     bool run_keycircle=(args[1]=="keycircle")||run_all;
     bool run_judgesign=(args[1]=="judgesign")||run_all;
     bool run_pipe=(args[1]=="pipe")||run_all;
+    bool run_journal=(args[1]=="journal")||run_all;
+    bool run_corpus=(args[1]=="corpus")||run_all;
+    bool run_random=(args[1]=="random")||run_all;
+    bool run_compiler=(args[1]=="compiler")||run_all;
+    bool run_reducer=(args[1]=="reducer")||run_all;
+    bool run_stats=(args[1]=="stats")||run_all;
+    bool run_coverage=(args[1]=="coverage")||run_all;
+    bool run_mutator=(args[1]=="mutator")||run_all;
+    bool run_bandit=(args[1]=="bandit")||run_all;
+    bool run_counters=(args[1]=="counters")||run_all;
+    bool run_placement=(args[1]=="placement")||run_all;
+    bool run_diagnosis=(args[1]=="diagnosis")||run_all;
 
     // 添加要运行的测试套件
     if (run_args) {
@@ -74,6 +98,54 @@ int main(int argc, char** argv) {
         manager.add_suite(create_pipe_tests());  // 添加Pipe测试套件
     }
 
+    if (run_journal) {
+        manager.add_suite(create_journal_tests());
+    }
+
+    if (run_corpus) {
+        manager.add_suite(create_corpus_tests());
+    }
+
+    if (run_random) {
+        manager.add_suite(create_random_tests());
+    }
+
+    if (run_compiler) {
+        manager.add_suite(create_compiler_tests());
+    }
+
+    if (run_reducer) {
+        manager.add_suite(create_reducer_tests());
+    }
+
+    if (run_stats) {
+        manager.add_suite(create_stats_tests());
+    }
+
+    if (run_coverage) {
+        manager.add_suite(create_coverage_tests());
+    }
+
+    if (run_mutator) {
+        manager.add_suite(create_mutator_tests());
+    }
+
+    if (run_bandit) {
+        manager.add_suite(create_bandit_tests());
+    }
+
+    if (run_counters) {
+        manager.add_suite(create_counters_tests());
+    }
+
+    if (run_placement) {
+        manager.add_suite(create_placement_tests());
+    }
+
+    if (run_diagnosis) {
+        manager.add_suite(create_diagnosis_tests());
+    }
+
     // 运行所有测试
     bool all_passed = manager.run_all();
 